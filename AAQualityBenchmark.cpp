@@ -0,0 +1,127 @@
+#include "AAQualityBenchmark.h"
+#include "HouseScene.h"
+#include "AccumulationRenderer.h"
+#include "PostProcessAA.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+// 16x16 jittered renders on a rotated grid, the stand-in for the real image
+static const int REFERENCE_SAMPLES = 256;
+
+// Same as FXAA's own edge threshold
+static const float EDGE_THRESHOLD = 0.1f;
+
+// RGBA floats of a colour texture, read through a throwaway framebuffer
+static vector<float> readTexture(GLuint texture, int width, int height) {
+	vector<float> pixels(width * height * 4);
+
+	GLuint readFBO;
+	glGenFramebuffers(1, &readFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, readFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_FLOAT, pixels.data());
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &readFBO);
+
+	return pixels;
+}
+
+static float luma(const vector<float> &pixels, int index) {
+
+	return 0.299f * pixels[index * 4] + 0.587f * pixels[index * 4 + 1] + 0.114f * pixels[index * 4 + 2];
+}
+
+// Pixels of the 1x render next to a luma step, the only ones AA should change
+static vector<bool> findEdges(const vector<float> &pixels, int width, int height) {
+	vector<bool> edges(width * height, false);
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			int i = y * width + x;
+			float centre = luma(pixels, i);
+
+			if ((x > 0 && fabs(centre - luma(pixels, i - 1)) > EDGE_THRESHOLD) ||
+				(x < width - 1 && fabs(centre - luma(pixels, i + 1)) > EDGE_THRESHOLD) ||
+				(y > 0 && fabs(centre - luma(pixels, i - width)) > EDGE_THRESHOLD) ||
+				(y < height - 1 && fabs(centre - luma(pixels, i + width)) > EDGE_THRESHOLD))
+				edges[i] = true;
+		}
+	}
+
+	return edges;
+}
+
+// Mean absolute RGB difference from the reference, over the edge pixels and over every pixel
+static void measureError(const vector<float> &pixels, const vector<float> &reference, const vector<bool> &edges, double *edgeError, double *allError) {
+	double edgeSum = 0.0, allSum = 0.0;
+	int edgeCount = 0;
+
+	for (size_t i = 0; i < edges.size(); i++) {
+		double error = (fabs(pixels[i * 4] - reference[i * 4]) + fabs(pixels[i * 4 + 1] - reference[i * 4 + 1]) +
+			fabs(pixels[i * 4 + 2] - reference[i * 4 + 2])) / 3.0;
+
+		allSum += error;
+		if (edges[i]) {
+			edgeSum += error;
+			edgeCount++;
+		}
+	}
+
+	*edgeError = edgeCount > 0 ? edgeSum / edgeCount : 0.0;
+	*allError = allSum / edges.size();
+}
+
+bool runAAQualityBenchmark(int width, int height) {
+	HouseScene scene(width, height, 1);
+
+	// The fallback programs shade differently, every render has to use the real ones
+	scene.finishShaders();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, scene.getHouseSceneFramebuffer());
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (!complete) {
+		printf("Couldn't create the scene's framebuffer\n");
+		return false;
+	}
+
+	AccumulationRenderer referenceRenderer(&scene, width, height, PATTERN_ROTATED_GRID, REFERENCE_SAMPLES);
+	referenceRenderer.render();
+	vector<float> reference = readTexture(referenceRenderer.getOutputTexture(), width, height);
+
+	scene.render();
+	vector<float> aliased = readTexture(scene.getHouseSceneTexture(), width, height);
+	vector<bool> edges = findEdges(aliased, width, height);
+
+	int edgeCount = 0;
+	for (bool edge : edges)
+		edgeCount += edge ? 1 : 0;
+
+	printf("AA error at %dx%d against a %d sample reference, %d edge pixels (%.1f%%)\n", width, height,
+		referenceRenderer.getSampleCount(), edgeCount, 100.0 * edgeCount / edges.size());
+	printf("%-5s %11s %11s\n", "mode", "edge error", "all error");
+
+	double edgeError, allError;
+	measureError(aliased, reference, edges, &edgeError, &allError);
+	printf("%-5s %11.4f %11.4f\n", "none", edgeError, allError);
+
+	const PostProcessAAMode modes[] = { POSTAA_FXAA, POSTAA_SMAA };
+	const char *modeNames[] = { "fxaa", "smaa" };
+
+	for (int m = 0; m < 2; m++) {
+		PostProcessAA postProcessAA(modes[m], width, height);
+		postProcessAA.apply(scene.getHouseSceneTexture());
+
+		measureError(readTexture(postProcessAA.getOutputTexture(), width, height), reference, edges, &edgeError, &allError);
+		printf("%-5s %11.4f %11.4f\n", modeNames[m], edgeError, allError);
+	}
+	fflush(stdout);
+
+	return true;
+}
@@ -0,0 +1,11 @@
+#ifndef AAQUALITYBENCHMARK_H
+#define AAQUALITYBENCHMARK_H
+
+// Compares the post-process AA modes against a 16x16 supersampled reference of the house scene (256
+// jittered renders accumulated) and prints the mean error per pixel for no AA, FXAA and SMAA, over
+// edge pixels and over the whole image. Edge pixels are the ones whose luma differs from a neighbour's
+// in the 1x render. Needs a current context.
+// Returns false if the scene couldn't be rendered.
+bool runAAQualityBenchmark(int width, int height);
+
+#endif
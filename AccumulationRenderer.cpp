@@ -0,0 +1,100 @@
+#include "AccumulationRenderer.h"
+#include "ShaderVariants.h"
+#include <iostream>
+
+using namespace std;
+
+AccumulationRenderer::AccumulationRenderer(HouseScene *newScene, int newOutputWidth, int newOutputHeight, SamplePattern newPattern, int sampleCount) {
+	scene = newScene;
+	outputWidth = newOutputWidth;
+	outputHeight = newOutputHeight;
+	pattern = newPattern;
+	offsets = generateSamplePattern(pattern, sampleCount);
+
+	GLSL_ERROR glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/Accumulate_shader.frag"),
+		&accumulateShader);
+
+	weightLocation = glGetUniformLocation(accumulateShader, "weight");
+
+	glUseProgram(accumulateShader);
+	glUniform1i(glGetUniformLocation(accumulateShader, "texture0"), 0);
+	glUniform1i(glGetUniformLocation(accumulateShader, "maskMode"), 0);
+	glUseProgram(0);
+
+	glGenVertexArrays(1, &emptyVAO);
+
+	glGenFramebuffers(1, &accumulationFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, accumulationFBO);
+
+	glGenTextures(1, &accumulationTexture);
+	glBindTexture(GL_TEXTURE_2D, accumulationTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, outputWidth, outputHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulationTexture, 0);
+
+	fboOkay = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (!fboOkay)
+		cout << "Could not successfully create framebuffer object for the accumulation buffer!" << endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+AccumulationRenderer::~AccumulationRenderer() {
+	glDeleteFramebuffers(1, &accumulationFBO);
+	glDeleteTextures(1, &accumulationTexture);
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(accumulateShader);
+}
+
+void AccumulationRenderer::render() {
+	if (!fboOkay)
+		return;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, accumulationFBO);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	float weight = 1.0f / offsets.size();
+
+	for (size_t i = 0; i < offsets.size(); i++) {
+		// A pixel is 2 / size wide in NDC, translating clip space shifts the whole image by the offset
+		glm::vec3 jitter(2.0f * offsets[i].x / outputWidth, 2.0f * offsets[i].y / outputHeight, 0.0f);
+		scene->render(glm::translate(glm::mat4(1.0), jitter), outputWidth, outputHeight);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, accumulationFBO);
+		glViewport(0, 0, outputWidth, outputHeight);
+
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+
+		glUseProgram(accumulateShader);
+		glUniform1f(weightLocation, weight);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, scene->getHouseSceneTexture());
+
+		glBindVertexArray(emptyVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glBindVertexArray(0);
+		glUseProgram(0);
+
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glEnable(GL_DEPTH_TEST);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GLuint AccumulationRenderer::getOutputTexture() {
+	return accumulationTexture;
+}
+
+int AccumulationRenderer::getSampleCount() {
+	return (int)offsets.size();
+}
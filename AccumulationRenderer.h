@@ -0,0 +1,44 @@
+#ifndef ACCUMULATIONRENDERER_H
+#define ACCUMULATIONRENDERER_H
+
+#include "Includes.h"
+#include "HouseScene.h"
+#include "SamplePatterns.h"
+#include <vector>
+
+// Supersamples by rendering the scene several times at the output resolution, each time with the
+// projection shifted by a sub-pixel offset, and adding the renders into one RGBA16F target.
+// Memory doesn't grow with the sample count, only the time does, so it can reach 64 or 256
+// samples for stills where the SSAA target would not fit.
+class AccumulationRenderer {
+	private:
+		HouseScene						*scene;
+
+		int								outputWidth;
+		int								outputHeight;
+
+		SamplePattern					pattern;
+		std::vector<glm::vec2>			offsets;
+
+		GLuint							accumulationFBO;
+		GLuint							accumulationTexture;
+		bool							fboOkay;
+
+		GLuint							emptyVAO;
+
+		GLuint							accumulateShader;
+		GLint							weightLocation;
+
+	public:
+		AccumulationRenderer(HouseScene *newScene, int newOutputWidth, int newOutputHeight, SamplePattern newPattern, int sampleCount);
+		~AccumulationRenderer();
+
+		// Renders every sample and leaves their average in the output texture
+		void render();
+
+		GLuint getOutputTexture();
+
+		// The actual count can differ from what was asked for (rotated grid rounds down to a square)
+		int getSampleCount();
+};
+#endif
@@ -0,0 +1,236 @@
+#include "AdaptiveSupersampler.h"
+#include "ShaderVariants.h"
+#include <iostream>
+
+using namespace std;
+
+// Edge thresholds, see EdgeMask_shader.frag
+static const float LUMA_THRESHOLD = 0.1f;
+static const float DEPTH_THRESHOLD = 0.05f;
+
+AdaptiveSupersampler::AdaptiveSupersampler(HouseScene *newScene, int newOutputWidth, int newOutputHeight, SamplePattern pattern, int sampleCount) {
+	scene = newScene;
+	outputWidth = newOutputWidth;
+	outputHeight = newOutputHeight;
+	offsets = generateSamplePattern(pattern, sampleCount);
+
+	GLSL_ERROR glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/EdgeMask_shader.frag"),
+		&edgeMaskShader);
+
+	glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/StencilMask_shader.frag"),
+		&stencilMaskShader);
+
+	glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/Accumulate_shader.frag"),
+		&accumulateShader);
+
+	glUseProgram(edgeMaskShader);
+	glUniform1i(glGetUniformLocation(edgeMaskShader, "colourTexture"), 0);
+	glUniform1i(glGetUniformLocation(edgeMaskShader, "depthTexture"), 1);
+	nearPlaneLocation = glGetUniformLocation(edgeMaskShader, "nearPlane");
+	farPlaneLocation = glGetUniformLocation(edgeMaskShader, "farPlane");
+	glUniform1f(glGetUniformLocation(edgeMaskShader, "lumaThreshold"), LUMA_THRESHOLD);
+	glUniform1f(glGetUniformLocation(edgeMaskShader, "depthThreshold"), DEPTH_THRESHOLD);
+
+	glUseProgram(stencilMaskShader);
+	glUniform1i(glGetUniformLocation(stencilMaskShader, "maskTexture"), 1);
+
+	weightLocation = glGetUniformLocation(accumulateShader, "weight");
+	maskModeLocation = glGetUniformLocation(accumulateShader, "maskMode");
+
+	glUseProgram(accumulateShader);
+	glUniform1i(glGetUniformLocation(accumulateShader, "texture0"), 0);
+	glUniform1i(glGetUniformLocation(accumulateShader, "maskTexture"), 1);
+	glUseProgram(0);
+
+	glGenVertexArrays(1, &emptyVAO);
+
+	fboOkay = true;
+	maskFBO = createTarget(GL_R8, &maskTexture);
+	outputFBO = createTarget(GL_RGBA16F, &outputTexture);
+
+	glGenQueries(QUERY_LATENCY, queries);
+	for (int i = 0; i < QUERY_LATENCY; i++)
+		queryIssued[i] = false;
+}
+
+AdaptiveSupersampler::~AdaptiveSupersampler() {
+	glDeleteFramebuffers(1, &maskFBO);
+	glDeleteFramebuffers(1, &outputFBO);
+	glDeleteTextures(1, &maskTexture);
+	glDeleteTextures(1, &outputTexture);
+	glDeleteQueries(QUERY_LATENCY, queries);
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(edgeMaskShader);
+	glDeleteProgram(stencilMaskShader);
+	glDeleteProgram(accumulateShader);
+}
+
+GLuint AdaptiveSupersampler::createTarget(GLint internalFormat, GLuint *texture) {
+	GLuint fbo;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+	glGenTextures(1, texture);
+	glBindTexture(GL_TEXTURE_2D, *texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, outputWidth, outputHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, *texture, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		fboOkay = false;
+		cout << "Could not successfully create framebuffer object for adaptive supersampling!" << endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return fbo;
+}
+
+// Reads back the pixel count of an earlier frame if it's ready, otherwise it's dropped
+void AdaptiveSupersampler::collectQuery(int slot) {
+	if (!queryIssued[slot])
+		return;
+
+	queryIssued[slot] = false;
+
+	GLint available = 0;
+	glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return;
+
+	GLuint pixels = 0;
+	glGetQueryObjectuiv(queries[slot], GL_QUERY_RESULT, &pixels);
+	refinedPercent = 100.0f * pixels / (outputWidth * outputHeight);
+}
+
+void AdaptiveSupersampler::drawFullscreen() {
+	glBindVertexArray(emptyVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+}
+
+void AdaptiveSupersampler::accumulate(float weight, int maskMode) {
+	glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+	glViewport(0, 0, outputWidth, outputHeight);
+
+	glUseProgram(accumulateShader);
+	glUniform1f(weightLocation, weight);
+	glUniform1i(maskModeLocation, maskMode);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, scene->getHouseSceneTexture());
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, maskTexture);
+
+	drawFullscreen();
+}
+
+void AdaptiveSupersampler::render() {
+	if (!fboOkay)
+		return;
+
+	int slot = frame % QUERY_LATENCY;
+	collectQuery(slot);
+
+	// 1x render of everything
+	scene->render();
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	// Find the edges
+	glBindFramebuffer(GL_FRAMEBUFFER, maskFBO);
+	glViewport(0, 0, outputWidth, outputHeight);
+
+	// Depth is linearised with the camera's own planes, taken from its projection like the light
+	// clusterer does, so they can't drift from what the scene was rendered with
+	glm::mat4 projection = scene->getHouseSceneCamera()->getProjectionMatrix();
+	glUseProgram(edgeMaskShader);
+	glUniform1f(nearPlaneLocation, projection[3][2] / (projection[2][2] - 1.0f));
+	glUniform1f(farPlaneLocation, projection[3][2] / (projection[2][2] + 1.0f));
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, scene->getHouseSceneTexture());
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, scene->getHouseSceneDepthTexture());
+	drawFullscreen();
+
+	// Flat pixels are finished, edge pixels start at 0 and have the jittered renders added
+	accumulate(1.0f, 2);
+
+	// Copy the mask into the scene's stencil buffer, counting how many pixels it covers
+	glBindFramebuffer(GL_FRAMEBUFFER, scene->getHouseSceneFramebuffer());
+	glViewport(0, 0, outputWidth, outputHeight);
+
+	glEnable(GL_STENCIL_TEST);
+	glStencilMask(0xFF);
+	glClearStencil(0);
+	glClear(GL_STENCIL_BUFFER_BIT);
+	glStencilFunc(GL_ALWAYS, 1, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+	glUseProgram(stencilMaskShader);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, maskTexture);
+
+	glBeginQuery(GL_SAMPLES_PASSED, queries[slot]);
+	drawFullscreen();
+	glEndQuery(GL_SAMPLES_PASSED);
+	queryIssued[slot] = true;
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+	glStencilFunc(GL_EQUAL, 1, 0xFF);
+
+	glUseProgram(0);
+	glActiveTexture(GL_TEXTURE0);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+
+	float weight = 1.0f / offsets.size();
+
+	for (size_t i = 0; i < offsets.size(); i++) {
+		// The stencil test keeps the scene's fragment shading to the edge pixels
+		glm::vec3 jitter(2.0f * offsets[i].x / outputWidth, 2.0f * offsets[i].y / outputHeight, 0.0f);
+
+		glEnable(GL_STENCIL_TEST);
+		scene->render(glm::translate(glm::mat4(1.0), jitter), outputWidth, outputHeight);
+		glDisable(GL_STENCIL_TEST);
+
+		glDisable(GL_DEPTH_TEST);
+		glBlendFunc(GL_ONE, GL_ONE);
+
+		accumulate(weight, 1);
+
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glEnable(GL_DEPTH_TEST);
+	}
+
+	glDisable(GL_STENCIL_TEST);
+	glUseProgram(0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	frame++;
+}
+
+GLuint AdaptiveSupersampler::getOutputTexture() {
+	return outputTexture;
+}
+
+int AdaptiveSupersampler::getSampleCount() {
+	return (int)offsets.size();
+}
+
+float AdaptiveSupersampler::getRefinedPercent() {
+	return refinedPercent;
+}
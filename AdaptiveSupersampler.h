@@ -0,0 +1,69 @@
+#ifndef ADAPTIVESUPERSAMPLER_H
+#define ADAPTIVESUPERSAMPLER_H
+
+#include "Includes.h"
+#include "HouseScene.h"
+#include "SamplePatterns.h"
+#include <vector>
+
+// Supersamples only the pixels that need it. The scene is rendered once at 1x, luminance edges and
+// depth discontinuities are marked in a mask which is copied into the scene's stencil buffer, then
+// the scene is rendered again once per sample with sub-pixel jitter and the stencil test on, so
+// only edge pixels are shaded again. Edge pixels get the average of the jittered renders, every
+// other pixel keeps the 1x result.
+class AdaptiveSupersampler {
+	private:
+		// Frames a refined pixel count is allowed to be in flight for before it's read back
+		static const int				QUERY_LATENCY = 3;
+
+		HouseScene						*scene;
+
+		int								outputWidth;
+		int								outputHeight;
+
+		std::vector<glm::vec2>			offsets;
+
+		// 1 where the pixel is an edge
+		GLuint							maskFBO;
+		GLuint							maskTexture;
+
+		// 1x result for flat pixels, jittered average for edge pixels (RGBA16F)
+		GLuint							outputFBO;
+		GLuint							outputTexture;
+
+		bool							fboOkay;
+
+		GLuint							emptyVAO;
+
+		GLuint							edgeMaskShader;
+		GLuint							stencilMaskShader;
+		GLuint							accumulateShader;
+		GLint							nearPlaneLocation;
+		GLint							farPlaneLocation;
+		GLint							weightLocation;
+		GLint							maskModeLocation;
+
+		// Counts the pixels written to the stencil mask each frame, read back a few frames later
+		GLuint							queries[QUERY_LATENCY];
+		bool							queryIssued[QUERY_LATENCY];
+		int								frame = 0;
+		float							refinedPercent = 0.0f;
+
+		GLuint							createTarget(GLint internalFormat, GLuint *texture);
+		void							collectQuery(int slot);
+		void							drawFullscreen();
+		void							accumulate(float weight, int maskMode);
+
+	public:
+		AdaptiveSupersampler(HouseScene *newScene, int newOutputWidth, int newOutputHeight, SamplePattern pattern, int sampleCount);
+		~AdaptiveSupersampler();
+
+		void render();
+
+		GLuint getOutputTexture();
+		int getSampleCount();
+
+		// Percentage of pixels that were supersampled, from a frame or two ago
+		float getRefinedPercent();
+};
+#endif
@@ -0,0 +1,259 @@
+#include "CommandLine.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+// Reads the value following an option, returns false if there isn't one
+static bool readValue(int argc, char **argv, int *i, const char **value) {
+	if (*i + 1 >= argc) {
+		cout << "Missing value for " << argv[*i] << endl;
+		return false;
+	}
+
+	*i += 1;
+	*value = argv[*i];
+	return true;
+}
+
+bool parseCommandLine(int argc, char **argv, AppSettings *settings) {
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *value = nullptr;
+
+		if (strcmp(arg, "--aa") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->aaType = value;
+		} else if (strcmp(arg, "--samples") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->samples = atoi(value);
+		} else if (strcmp(arg, "--msaa-resolve") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->msaaResolve = value;
+		} else if (strcmp(arg, "--sample-shading") == 0) {
+			settings->sampleShading = true;
+		} else if (strcmp(arg, "--ssaa-tile") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->ssaaTile = atoi(value);
+		} else if (strcmp(arg, "--dynamic-res") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->dynamicResTargetMs = (float)atof(value);
+		} else if (strcmp(arg, "--dynamic-res-max") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->dynamicResMaxScale = (float)atof(value);
+		} else if (strcmp(arg, "--resolve-filter") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->resolveFilter = value;
+		} else if (strcmp(arg, "--resolve-bench") == 0) {
+			settings->resolveBench = true;
+		} else if (strcmp(arg, "--resolve-bench-csv") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->resolveBenchCSV = value;
+			settings->resolveBench = true;
+		} else if (strcmp(arg, "--accum-samples") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->accumSamples = atoi(value);
+		} else if (strcmp(arg, "--jitter") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->jitterPattern = value;
+		} else if (strcmp(arg, "--fence-rings") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->fenceRings = atoi(value);
+		} else if (strcmp(arg, "--no-occlusion") == 0) {
+			settings->occlusionCulling = false;
+		} else if (strcmp(arg, "--no-software-occlusion") == 0) {
+			settings->softwareOcclusion = false;
+		} else if (strcmp(arg, "--occlusion-bench") == 0) {
+			settings->occlusionBench = true;
+		} else if (strcmp(arg, "--lights") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->extraLights = atoi(value);
+		} else if (strcmp(arg, "--no-light-clustering") == 0) {
+			settings->lightClustering = false;
+		} else if (strcmp(arg, "--light-bench") == 0) {
+			settings->lightBench = true;
+		} else if (strcmp(arg, "--aa-quality") == 0) {
+			settings->aaQuality = true;
+		} else if (strcmp(arg, "--shading") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->shading = value;
+		} else if (strcmp(arg, "--no-shader-cache") == 0) {
+			settings->shaderCache = false;
+		} else if (strcmp(arg, "--shader-cache") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->shaderCacheDir = value;
+		} else if (strcmp(arg, "--headless") == 0) {
+			settings->headless = true;
+		} else if (strcmp(arg, "--frames") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->headlessFrames = atoi(value);
+		} else if (strcmp(arg, "--output") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->outputDir = value;
+		} else if (strcmp(arg, "--no-images") == 0) {
+			settings->saveFrames = false;
+		} else if (strcmp(arg, "--benchmark") == 0) {
+			settings->benchmark = true;
+		} else if (strcmp(arg, "--bench-warmup") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->benchWarmupSeconds = (float)atof(value);
+		} else if (strcmp(arg, "--bench-frames") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->benchFrames = atoi(value);
+		} else if (strcmp(arg, "--bench-bucket") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->benchBucketMs = (float)atof(value);
+		} else if (strcmp(arg, "--bench-label") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->benchLabel = value;
+		} else if (strcmp(arg, "--bench-csv") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->benchCSV = value;
+			settings->benchmark = true;
+		} else if (strcmp(arg, "--bench-json") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->benchJSON = value;
+			settings->benchmark = true;
+		} else if (strcmp(arg, "--profile") == 0) {
+			settings->profile = true;
+		} else if (strcmp(arg, "--profile-csv") == 0) {
+			if (!readValue(argc, argv, &i, &value))
+				return false;
+			settings->profileCSV = value;
+			settings->profile = true;
+		} else if (strcmp(arg, "--verify-resolve") == 0) {
+			settings->verifyResolve = true;
+		} else if (strcmp(arg, "--help") == 0) {
+			printUsage(argv[0]);
+			return false;
+		} else {
+			cout << "Unknown option " << arg << endl;
+			printUsage(argv[0]);
+			return false;
+		}
+	}
+
+	if (!settings->aaType.empty() && settings->aaType != "none" && settings->aaType != "msaa" && settings->aaType != "ssaa" && settings->aaType != "accum" && settings->aaType != "taa"
+		&& settings->aaType != "adaptive" && settings->aaType != "fxaa" && settings->aaType != "smaa") {
+		cout << "--aa must be none, msaa, ssaa, accum, taa, adaptive, fxaa or smaa" << endl;
+		return false;
+	}
+
+	if (settings->msaaResolve != "blit" && settings->msaaResolve != "shader") {
+		cout << "--msaa-resolve must be blit or shader" << endl;
+		return false;
+	}
+
+	if (settings->ssaaTile < 0) {
+		cout << "--ssaa-tile can't be negative" << endl;
+		return false;
+	}
+
+	if (settings->dynamicResTargetMs < 0.0f || settings->dynamicResMaxScale < 1.0f) {
+		cout << "--dynamic-res can't be negative and --dynamic-res-max must be at least 1" << endl;
+		return false;
+	}
+
+	if (settings->resolveFilter != "box" && settings->resolveFilter != "mitchell" && settings->resolveFilter != "lanczos"
+		&& settings->resolveFilter != "gaussian") {
+		cout << "--resolve-filter must be box, mitchell, lanczos or gaussian" << endl;
+		return false;
+	}
+
+	if (settings->shading != "forward" && settings->shading != "deferred") {
+		cout << "--shading must be forward or deferred" << endl;
+		return false;
+	}
+
+	if (settings->accumSamples < 0) {
+		cout << "--accum-samples can't be negative" << endl;
+		return false;
+	}
+
+	if (settings->jitterPattern != "rotated" && settings->jitterPattern != "halton" && settings->jitterPattern != "poisson") {
+		cout << "--jitter must be rotated, halton or poisson" << endl;
+		return false;
+	}
+
+	if (settings->fenceRings < 1) {
+		cout << "--fence-rings must be at least 1" << endl;
+		return false;
+	}
+
+	if (settings->headlessFrames < 1) {
+		cout << "--frames must be at least 1" << endl;
+		return false;
+	}
+
+	if (settings->benchFrames < 1 || settings->benchBucketMs <= 0.0f || settings->benchWarmupSeconds < 0.0f) {
+		cout << "--bench-frames and --bench-bucket must be positive and --bench-warmup can't be negative" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+void printUsage(const char *programName) {
+	cout << "Usage: " << programName << " [options]" << endl;
+	cout << "  --aa TYPE         anti-aliasing type: none, msaa, ssaa, accum, taa, adaptive, fxaa or smaa" << endl;
+	cout << "                    (default ssaa)" << endl;
+	cout << "  --samples N       MSAA samples or SSAA factor (default 8)" << endl;
+	cout << "  --msaa-resolve R  resolve MSAA with blit (glBlitFramebuffer) or shader (default blit)" << endl;
+	cout << "  --sample-shading  run the fragment shader per sample in MSAA mode" << endl;
+	cout << "  --ssaa-tile N     render SSAA in tiles of at most N x N texels, 0 for no tiling (default 0)" << endl;
+	cout << "  --dynamic-res MS  pick the SSAA scale each frame to keep the scene pass near MS of GPU time" << endl;
+	cout << "  --dynamic-res-max S largest dynamic resolution scale, can be fractional (default 2)" << endl;
+	cout << "  --resolve-filter F SSAA resolve filter: box, mitchell, lanczos or gaussian (default box)" << endl;
+	cout << "  --resolve-bench   time every resolve filter at 1080p and 4K with factors 2-4 and exit" << endl;
+	cout << "  --resolve-bench-csv FILE also write the resolve timings to FILE (implies --resolve-bench)" << endl;
+	cout << "  --accum-samples N jittered renders per frame in accum and adaptive modes (default samples^2)" << endl;
+	cout << "  --jitter PATTERN  accum/adaptive sample pattern: rotated, halton or poisson (default rotated)" << endl;
+	cout << "  --fence-rings N   draw N rings of 15 fence segments, for stress testing instancing (default 1)" << endl;
+	cout << "  --no-occlusion    draw models even when occlusion queries show they're hidden" << endl;
+	cout << "  --no-software-occlusion don't cull models hidden behind the house or land on the CPU" << endl;
+	cout << "  --occlusion-bench time the CPU occlusion culler (triangles/s and tests/s) and exit" << endl;
+	cout << "  --lights N        add N torch lights around the house to stress the lighting (default 0)" << endl;
+	cout << "  --no-light-clustering shade every fragment with every light instead of its cluster's lights" << endl;
+	cout << "  --light-bench     time forward and deferred shading with 1 to 4096 lights at SSAA x1 to x8, and forward at MSAA x4 and x8, and exit" << endl;
+	cout << "  --aa-quality      print the error of no AA, FXAA and SMAA against a 16x16 supersampled render and exit" << endl;
+	cout << "  --shading PATH    forward or deferred (G-buffer) lighting, MSAA is always forward (default forward)" << endl;
+	cout << "  --shader-cache DIR directory for cached program binaries (default ShaderCache)" << endl;
+	cout << "  --no-shader-cache compile every shader from source, without reading or writing the cache" << endl;
+	cout << "  --headless        render offscreen without a window" << endl;
+	cout << "  --frames N        number of frames to render in headless mode (default 100)" << endl;
+	cout << "  --output DIR      directory for headless frames and timings (default HeadlessOutput)" << endl;
+	cout << "  --no-images       only write timings in headless mode" << endl;
+	cout << "  --benchmark       record frame times and print p50/p95/p99/max when done" << endl;
+	cout << "  --bench-warmup S  seconds to run before recording (default 3)" << endl;
+	cout << "  --bench-frames N  number of frames to record (default 5000)" << endl;
+	cout << "  --bench-bucket MS histogram bucket width in ms (default 1)" << endl;
+	cout << "  --bench-label L   name written into the results, e.g. the build being measured" << endl;
+	cout << "  --bench-csv FILE  write every recorded frame time to FILE (implies --benchmark)" << endl;
+	cout << "  --bench-json FILE write the summary and histogram to FILE (implies --benchmark)" << endl;
+	cout << "  --profile         print the CPU and GPU time of every render pass and the draw counts once a second" << endl;
+	cout << "  --profile-csv F   write the CPU and GPU time of every pass of every frame to F (implies --profile)" << endl;
+	cout << "  --verify-resolve  compare the first SSAA resolve against a CPU box filter" << endl;
+}
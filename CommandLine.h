@@ -0,0 +1,102 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include <string>
+
+// Settings that can be changed from the command line without recompiling
+struct AppSettings {
+	// Anti-aliasing type ("none", "msaa", "ssaa", "accum", "taa", "adaptive",
+	// "fxaa" or "smaa") and sample count, empty/0 keeps the built in defaults
+	std::string		aaType;
+	int				samples = 0;
+
+	// MSAA options: resolve with glBlitFramebuffer ("blit") or a texelFetch shader ("shader"),
+	// and whether to shade every sample rather than every pixel
+	std::string		msaaResolve = "blit";
+	bool			sampleShading = false;
+
+	// Render SSAA in tiles no bigger than this many texels a side (0 renders the whole image at once)
+	int				ssaaTile = 0;
+
+	// SSAA dynamic resolution: GPU time to aim for in the scene pass (0 is off) and the largest
+	// render scale per axis, fractional scales are allowed
+	float			dynamicResTargetMs = 0.0f;
+	float			dynamicResMaxScale = 2.0f;
+
+	// SSAA resolve filter ("box", "mitchell", "lanczos" or "gaussian")
+	std::string		resolveFilter = "box";
+
+	// Time every resolve filter at 1080p and 4K for several factors, print the results and exit
+	bool			resolveBench = false;
+	std::string		resolveBenchCSV;
+
+	// Accumulation and adaptive modes: number of jittered renders (0 uses samples^2, like SSAA) and their
+	// sub-pixel pattern ("rotated", "halton" or "poisson")
+	int				accumSamples = 0;
+	std::string		jitterPattern = "rotated";
+
+	// Number of fence rings around the house, more than 1 stress tests instanced drawing
+	int				fenceRings = 1;
+
+	// Skip models hidden behind others using occlusion queries
+	bool			occlusionCulling = true;
+
+	// Skip models hidden behind the house or land using a depth buffer drawn on the CPU
+	bool			softwareOcclusion = true;
+
+	// Time the CPU occlusion culler, print the results and exit
+	bool			occlusionBench = false;
+
+	// Extra torch lights placed around the house, stress tests the clustered lighting
+	int				extraLights = 0;
+
+	// Only shade the point lights in each fragment's cluster rather than every light (off with --no-light-clustering)
+	bool			lightClustering = true;
+
+	// Time the house scene with 1 to 4096 lights, print the results and exit
+	bool			lightBench = false;
+
+	// Measure how far no AA, FXAA and SMAA are from a 16x16 supersampled render, print it and exit
+	bool			aaQuality = false;
+
+	// Lighting path ("forward" or "deferred"), MSAA always renders forward
+	std::string		shading = "forward";
+
+	// Keep linked shader programs on disk so later runs don't compile them again, and where to put them
+	bool			shaderCache = true;
+	std::string		shaderCacheDir = "ShaderCache";
+
+	// Render without a window (offscreen context) for a fixed number of frames
+	bool			headless = false;
+	int				headlessFrames = 100;
+
+	// Where the headless frames and timings are written to
+	std::string		outputDir = "HeadlessOutput";
+
+	// Write every resolved frame as an image (timings are always written)
+	bool			saveFrames = true;
+
+	// Record frame times after a warm-up and report them when enough frames are collected
+	bool			benchmark = false;
+	float			benchWarmupSeconds = 3.0f;
+	int				benchFrames = 5000;
+	float			benchBucketMs = 1.0f;
+	std::string		benchLabel = "default";
+
+	// Optional result files (empty means don't write)
+	std::string		benchCSV;
+	std::string		benchJSON;
+
+	// Time every render pass on the CPU and GPU
+	bool			profile = false;
+	std::string		profileCSV;
+
+	// Check the first SSAA resolve against a box filter done on the CPU
+	bool			verifyResolve = false;
+};
+
+// Returns false if the arguments could not be parsed (usage is printed)
+bool parseCommandLine(int argc, char **argv, AppSettings *settings);
+void printUsage(const char *programName);
+
+#endif
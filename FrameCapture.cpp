@@ -0,0 +1,93 @@
+#include "FrameCapture.h"
+#include <fstream>
+#include <iostream>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+FrameCapture::FrameCapture(int newWidth, int newHeight) {
+	width = newWidth;
+	height = newHeight;
+
+	glGenFramebuffers(1, &captureFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+
+	glGenTextures(1, &colourTexture);
+	glBindTexture(GL_TEXTURE_2D, colourTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// The resolve quad is drawn with depth testing on, so give it a depth buffer like the window has
+	glGenRenderbuffers(1, &depthRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colourTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+
+	fboOkay = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (!fboOkay)
+		cout << "Could not successfully create framebuffer object to capture frames!" << endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	pixels.resize(width * height * 3);
+}
+
+FrameCapture::~FrameCapture() {
+	glDeleteFramebuffers(1, &captureFBO);
+	glDeleteTextures(1, &colourTexture);
+	glDeleteRenderbuffers(1, &depthRenderbuffer);
+}
+
+GLuint FrameCapture::getFramebuffer() {
+	return captureFBO;
+}
+
+bool FrameCapture::isOkay() {
+	return fboOkay;
+}
+
+bool FrameCapture::saveFrame(const string &path) {
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, captureFBO);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	ofstream file(path, ios::binary);
+	if (!file) {
+		cout << "Could not open " << path << " for writing" << endl;
+		return false;
+	}
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+
+	// OpenGL rows start at the bottom of the image, PPM rows start at the top
+	int rowSize = width * 3;
+	for (int y = height - 1; y >= 0; y--)
+		file.write((const char*)&pixels[y * rowSize], rowSize);
+
+	return true;
+}
+
+bool FrameCapture::createDirectory(const string &path) {
+#ifdef _WIN32
+	int result = _mkdir(path.c_str());
+#else
+	int result = mkdir(path.c_str(), 0755);
+#endif
+
+	if (result != 0 && errno != EEXIST) {
+		cout << "Could not create output directory " << path << endl;
+		return false;
+	}
+
+	return true;
+}
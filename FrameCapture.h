@@ -0,0 +1,34 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include "Includes.h"
+#include <vector>
+
+// Stands in for the window's framebuffer when rendering headless.
+// The resolved frame is drawn into this FBO and can then be read back and saved to disk.
+class FrameCapture {
+	private:
+		int								width;
+		int								height;
+
+		GLuint							captureFBO;
+		GLuint							colourTexture;
+		GLuint							depthRenderbuffer;
+
+		bool							fboOkay;
+
+		std::vector<unsigned char>		pixels;
+
+	public:
+		FrameCapture(int newWidth, int newHeight);
+		~FrameCapture();
+
+		GLuint getFramebuffer();
+		bool isOkay();
+
+		// Reads the current contents back and writes it as a binary PPM (P6) image
+		bool saveFrame(const std::string &path);
+
+		static bool createDirectory(const std::string &path);
+};
+#endif
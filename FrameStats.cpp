@@ -0,0 +1,187 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+// Stops the histogram from growing without limit when a single frame takes seconds
+static const int MAX_HISTOGRAM_BUCKETS = 256;
+
+// Quotes, backslashes and control characters would break the string they're written into
+static string escapeJSON(const string &text) {
+	string escaped;
+
+	for (unsigned char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+			escaped += c;
+		} else if (c < 0x20) {
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", c);
+			escaped += code;
+		} else {
+			escaped += c;
+		}
+	}
+
+	return escaped;
+}
+
+FrameStats::FrameStats(float newWarmupSeconds, int newSampleCount, float newBucketMs) {
+	warmupSeconds = newWarmupSeconds;
+	sampleCount = newSampleCount;
+	bucketMs = newBucketMs;
+
+	frameTimes.reserve(sampleCount);
+}
+
+void FrameStats::addFrame(float frameSeconds) {
+	if (isWarmingUp()) {
+		warmupElapsed += frameSeconds;
+		return;
+	}
+
+	if (isFinished())
+		return;
+
+	frameTimes.push_back(frameSeconds * 1000.0f);
+	summaryDirty = true;
+}
+
+bool FrameStats::isWarmingUp() {
+	return warmupElapsed < warmupSeconds;
+}
+
+bool FrameStats::isFinished() {
+	return (int)frameTimes.size() >= sampleCount;
+}
+
+int FrameStats::getRecordedFrames() {
+	return (int)frameTimes.size();
+}
+
+void FrameStats::sortTimes() {
+	if (!summaryDirty)
+		return;
+
+	sortedTimes = frameTimes;
+	sort(sortedTimes.begin(), sortedTimes.end());
+	summaryDirty = false;
+}
+
+float FrameStats::meanFrameTime() {
+	if (frameTimes.empty())
+		return 0.0f;
+
+	double sum = 0.0;
+	for (float t : frameTimes)
+		sum += t;
+
+	return (float)(sum / frameTimes.size());
+}
+
+// Nearest-rank percentile, p in the range 0-100
+float FrameStats::percentile(float p) {
+	if (frameTimes.empty())
+		return 0.0f;
+
+	sortTimes();
+
+	int rank = (int)ceil(p / 100.0f * sortedTimes.size());
+	rank = max(1, min(rank, (int)sortedTimes.size()));
+
+	return sortedTimes[rank - 1];
+}
+
+float FrameStats::maxFrameTime() {
+	if (frameTimes.empty())
+		return 0.0f;
+
+	sortTimes();
+	return sortedTimes.back();
+}
+
+float FrameStats::minFrameTime() {
+	if (frameTimes.empty())
+		return 0.0f;
+
+	sortTimes();
+	return sortedTimes.front();
+}
+
+vector<int> FrameStats::histogram() {
+	int buckets = min((int)(maxFrameTime() / bucketMs) + 1, MAX_HISTOGRAM_BUCKETS);
+	vector<int> counts(buckets, 0);
+
+	// Anything past the last bucket is counted in it
+	for (float t : frameTimes)
+		counts[min((int)(t / bucketMs), buckets - 1)]++;
+
+	return counts;
+}
+
+void FrameStats::printSummary(const string &label) {
+	float mean = meanFrameTime();
+
+	cout << "Benchmark " << label << ": " << frameTimes.size() << " frames" << endl;
+	cout << "  mean " << mean << " ms (" << (mean > 0.0f ? 1000.0f / mean : 0.0f) << " fps)" << endl;
+	cout << "  min " << minFrameTime() << " ms, p50 " << percentile(50.0f) << " ms, p95 " << percentile(95.0f)
+		<< " ms, p99 " << percentile(99.0f) << " ms, max " << maxFrameTime() << " ms" << endl;
+}
+
+bool FrameStats::writeCSV(const string &path) {
+	ofstream file(path);
+	if (!file) {
+		cout << "Could not open " << path << " for writing" << endl;
+		return false;
+	}
+
+	file << "frame,frame_ms" << endl;
+	writeCSVRows(file, "");
+
+	return true;
+}
+
+bool FrameStats::writeJSON(const string &path, const string &label) {
+	ofstream file(path);
+	if (!file) {
+		cout << "Could not open " << path << " for writing" << endl;
+		return false;
+	}
+
+	writeJSONObject(file, label, "");
+	file << endl;
+
+	return true;
+}
+
+void FrameStats::writeCSVRows(ostream &file, const string &rowPrefix) {
+	for (size_t i = 0; i < frameTimes.size(); i++)
+		file << rowPrefix << i << "," << frameTimes[i] << endl;
+}
+
+// No newline after the closing brace so the caller can follow it with a comma
+void FrameStats::writeJSONObject(ostream &file, const string &label, const string &indent) {
+	file << indent << "{" << endl;
+	file << indent << "  \"label\": \"" << escapeJSON(label) << "\"," << endl;
+	file << indent << "  \"frames\": " << frameTimes.size() << "," << endl;
+	file << indent << "  \"warmup_seconds\": " << warmupSeconds << "," << endl;
+	file << indent << "  \"mean_ms\": " << meanFrameTime() << "," << endl;
+	file << indent << "  \"min_ms\": " << minFrameTime() << "," << endl;
+	file << indent << "  \"p50_ms\": " << percentile(50.0f) << "," << endl;
+	file << indent << "  \"p95_ms\": " << percentile(95.0f) << "," << endl;
+	file << indent << "  \"p99_ms\": " << percentile(99.0f) << "," << endl;
+	file << indent << "  \"max_ms\": " << maxFrameTime() << "," << endl;
+	file << indent << "  \"histogram_bucket_ms\": " << bucketMs << "," << endl;
+	file << indent << "  \"histogram\": [";
+
+	vector<int> counts = histogram();
+	for (size_t i = 0; i < counts.size(); i++)
+		file << (i ? ", " : "") << counts[i];
+
+	file << "]" << endl;
+	file << indent << "}";
+}
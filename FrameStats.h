@@ -0,0 +1,57 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Collects frame times for a benchmark run and reports percentiles, a histogram and CSV/JSON output.
+// Frames are ignored until the warm-up time has passed, then sampleCount frames are recorded.
+class FrameStats {
+	private:
+		float							warmupSeconds;
+		int								sampleCount;
+		float							bucketMs;
+
+		float							warmupElapsed = 0.0f;
+		bool							summaryDirty = true;
+
+		// Frame times in milliseconds, in the order they were recorded
+		std::vector<float>				frameTimes;
+
+		// Frame times in milliseconds, sorted (rebuilt when needed for percentiles)
+		std::vector<float>				sortedTimes;
+
+		void							sortTimes();
+
+	public:
+		FrameStats(float newWarmupSeconds = 3.0f, int newSampleCount = 5000, float newBucketMs = 1.0f);
+
+		// Record the duration of one frame
+		void addFrame(float frameSeconds);
+
+		bool isWarmingUp();
+		bool isFinished();
+		int getRecordedFrames();
+
+		// Statistics in milliseconds
+		float meanFrameTime();
+		float percentile(float p);
+		float maxFrameTime();
+		float minFrameTime();
+
+		// Number of frames in each bucketMs wide bucket, starting at 0ms
+		std::vector<int> histogram();
+
+		void printSummary(const std::string &label);
+
+		// CSV has one row per recorded frame, JSON has the summary and histogram
+		bool writeCSV(const std::string &path);
+		bool writeJSON(const std::string &path, const std::string &label);
+
+		// What writeCSV and writeJSON write, for putting several runs in one file. Each CSV row starts
+		// with rowPrefix, the JSON object's lines with indent.
+		void writeCSVRows(std::ostream &file, const std::string &rowPrefix);
+		void writeJSONObject(std::ostream &file, const std::string &label, const std::string &indent);
+};
+#endif
@@ -0,0 +1,88 @@
+#include "Frustum.h"
+#include <algorithm>
+#include <cfloat>
+
+using namespace std;
+
+BoundingBox BoundingBox::everything() {
+	BoundingBox box;
+	box.min = glm::vec3(-FLT_MAX);
+	box.max = glm::vec3(FLT_MAX);
+	return box;
+}
+
+// Model keeps the vertices it loaded, so the file doesn't have to be read again
+BoundingBox BoundingBox::fromModel(Model *model) {
+	BoundingBox box;
+	box.min = glm::vec3(FLT_MAX);
+	box.max = glm::vec3(-FLT_MAX);
+
+	for (const Mesh &mesh : model->meshes) {
+		for (const Vertex &vertex : mesh.vertices) {
+			box.min = glm::min(box.min, vertex.Position);
+			box.max = glm::max(box.max, vertex.Position);
+		}
+	}
+
+	if (box.min.x > box.max.x)
+		return everything();
+
+	return box;
+}
+
+// Transforms the centre and takes the absolute of the matrix for the extents (Arvo's method)
+BoundingBox BoundingBox::transformed(const glm::mat4 &matrix) const {
+	if (min.x == -FLT_MAX)
+		return *this;
+
+	BoundingBox result;
+
+	for (int i = 0; i < 3; i++) {
+		float centre = matrix[3][i];
+		float extent = 0.0f;
+
+		for (int j = 0; j < 3; j++) {
+			float boxCentre = (min[j] + max[j]) * 0.5f;
+			float boxExtent = (max[j] - min[j]) * 0.5f;
+
+			centre += matrix[j][i] * boxCentre;
+			extent += fabs(matrix[j][i]) * boxExtent;
+		}
+
+		result.min[i] = centre - extent;
+		result.max[i] = centre + extent;
+	}
+
+	return result;
+}
+
+// Planes come from adding/subtracting the matrix rows (Gribb and Hartmann)
+Frustum::Frustum(const glm::mat4 &viewProjection) {
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	planes[0] = rows[3] + rows[0]; // left
+	planes[1] = rows[3] - rows[0]; // right
+	planes[2] = rows[3] + rows[1]; // bottom
+	planes[3] = rows[3] - rows[1]; // top
+	planes[4] = rows[3] + rows[2]; // near
+	planes[5] = rows[3] - rows[2]; // far
+}
+
+bool Frustum::intersects(const BoundingBox &box) const {
+	if (box.min.x == -FLT_MAX)
+		return true;
+
+	for (const glm::vec4 &plane : planes) {
+		// Corner of the box furthest along the plane normal
+		float x = plane.x > 0.0f ? box.max.x : box.min.x;
+		float y = plane.y > 0.0f ? box.max.y : box.min.y;
+		float z = plane.z > 0.0f ? box.max.z : box.min.z;
+
+		if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
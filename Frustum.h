@@ -0,0 +1,34 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "Includes.h"
+
+// Axis aligned box, in model space or world space depending on where it came from
+struct BoundingBox {
+	glm::vec3		min;
+	glm::vec3		max;
+
+	// A box that every frustum intersects, for things without proper bounds
+	static BoundingBox everything();
+
+	// Bounds of all the vertices of a loaded model, everything() if it has none (it couldn't be loaded)
+	static BoundingBox fromModel(Model *model);
+
+	// Bounds of this box after transforming it by matrix (can be larger than the transformed contents)
+	BoundingBox transformed(const glm::mat4 &matrix) const;
+};
+
+// The six planes of a view-projection matrix's view volume, for culling anything outside it
+class Frustum {
+	private:
+		// xyz is the normal pointing into the volume, w the distance
+		glm::vec4						planes[6];
+
+	public:
+		Frustum(const glm::mat4 &viewProjection);
+
+		// False only if the box is completely outside one of the planes. Boxes near a corner
+		// can pass without being visible, that only costs a draw.
+		bool intersects(const BoundingBox &box) const;
+};
+#endif
@@ -0,0 +1,54 @@
+#include "GLExtensions.h"
+#include <cstring>
+
+using namespace std;
+
+GLADloadproc GLExtensions::loader = nullptr;
+PFN_MINSAMPLESHADING GLExtensions::minSampleShading = nullptr;
+PFN_GETPROGRAMBINARY GLExtensions::getProgramBinary = nullptr;
+PFN_PROGRAMBINARY GLExtensions::programBinary = nullptr;
+PFN_PROGRAMPARAMETERI GLExtensions::programParameteri = nullptr;
+PFN_MAXSHADERCOMPILERTHREADS GLExtensions::maxShaderCompilerThreads = nullptr;
+
+void GLExtensions::load(GLADloadproc newLoader) {
+	loader = newLoader;
+
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	int version = major * 10 + minor;
+
+	// Some loaders return non-null pointers for anything, so only ask for entry points the driver reports
+	if (version >= 40)
+		minSampleShading = (PFN_MINSAMPLESHADING)loader("glMinSampleShading");
+	else if (hasExtension("GL_ARB_sample_shading"))
+		minSampleShading = (PFN_MINSAMPLESHADING)loader("glMinSampleShadingARB");
+
+	// The ARB extension uses the core names
+	if (version >= 41 || hasExtension("GL_ARB_get_program_binary")) {
+		getProgramBinary = (PFN_GETPROGRAMBINARY)loader("glGetProgramBinary");
+		programBinary = (PFN_PROGRAMBINARY)loader("glProgramBinary");
+		programParameteri = (PFN_PROGRAMPARAMETERI)loader("glProgramParameteri");
+	}
+
+	if (hasExtension("GL_KHR_parallel_shader_compile"))
+		maxShaderCompilerThreads = (PFN_MAXSHADERCOMPILERTHREADS)loader("glMaxShaderCompilerThreadsKHR");
+	else if (hasExtension("GL_ARB_parallel_shader_compile"))
+		maxShaderCompilerThreads = (PFN_MAXSHADERCOMPILERTHREADS)loader("glMaxShaderCompilerThreadsARB");
+
+	// Some drivers only compile in the background once asked to, 0xFFFFFFFF lets them pick the thread count
+	if (maxShaderCompilerThreads)
+		maxShaderCompilerThreads(0xFFFFFFFF);
+}
+
+bool GLExtensions::hasExtension(const char *name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+	for (GLint i = 0; i < count; i++) {
+		if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+			return true;
+	}
+
+	return false;
+}
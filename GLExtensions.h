@@ -0,0 +1,55 @@
+#ifndef GLEXTENSIONS_H
+#define GLEXTENSIONS_H
+
+#include "Includes.h"
+
+// glad is generated for core OpenGL 3.3 without extensions. Newer entry points that are used when
+// the driver has them are loaded here instead, everything else still goes through glad.
+
+// GL 4.0 / ARB_sample_shading
+#ifndef GL_SAMPLE_SHADING
+#define GL_SAMPLE_SHADING					0x8C36
+#endif
+
+// GL 4.1 / ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+#define GL_PROGRAM_BINARY_LENGTH			0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS		0x87FE
+#endif
+
+// KHR_parallel_shader_compile / ARB_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR	0x91B0
+#define GL_COMPLETION_STATUS_KHR			0x91B1
+#endif
+
+typedef void (APIENTRYP PFN_MINSAMPLESHADING)(GLfloat value);
+typedef void (APIENTRYP PFN_GETPROGRAMBINARY)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFN_PROGRAMBINARY)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP PFN_PROGRAMPARAMETERI)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFN_MAXSHADERCOMPILERTHREADS)(GLuint count);
+
+class GLExtensions {
+	private:
+		static GLADloadproc				loader;
+
+	public:
+		// Call once the context is current, with the same loader glad was given
+		static void load(GLADloadproc newLoader);
+
+		static bool hasExtension(const char *name);
+
+		// Per-sample shading (GL 4.0 or ARB_sample_shading), null if unsupported
+		static PFN_MINSAMPLESHADING		minSampleShading;
+
+		// Saving and loading linked programs (GL 4.1 or ARB_get_program_binary), all null if unsupported
+		static PFN_GETPROGRAMBINARY		getProgramBinary;
+		static PFN_PROGRAMBINARY		programBinary;
+		static PFN_PROGRAMPARAMETERI	programParameteri;
+
+		// Compiling and linking on the driver's own threads (KHR or ARB_parallel_shader_compile), null if
+		// unsupported. When it's there GL_COMPLETION_STATUS_KHR can be polled without blocking.
+		static PFN_MAXSHADERCOMPILERTHREADS maxShaderCompilerThreads;
+};
+#endif
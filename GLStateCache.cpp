@@ -0,0 +1,50 @@
+#include "GLStateCache.h"
+
+using namespace std;
+
+static const GLuint UNKNOWN = ~0u;
+
+GLStateCache::GLStateCache() {
+	invalidate();
+}
+
+void GLStateCache::invalidate() {
+	program = UNKNOWN;
+	activeUnit = UNKNOWN;
+	frontFace = UNKNOWN;
+
+	for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+		textures[i] = UNKNOWN;
+}
+
+void GLStateCache::useProgram(GLuint newProgram) {
+	if (newProgram == program)
+		return;
+
+	glUseProgram(newProgram);
+	program = newProgram;
+}
+
+void GLStateCache::bindTexture(int unit, GLuint texture) {
+	// Units past the cached ones are still bound, just never skipped
+	if (unit < MAX_TEXTURE_UNITS && textures[unit] == texture)
+		return;
+
+	if (activeUnit != (GLenum)unit) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		activeUnit = unit;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	if (unit < MAX_TEXTURE_UNITS)
+		textures[unit] = texture;
+}
+
+void GLStateCache::setFrontFace(GLenum winding) {
+	if (winding == frontFace)
+		return;
+
+	glFrontFace(winding);
+	frontFace = winding;
+}
@@ -0,0 +1,32 @@
+#ifndef GLSTATECACHE_H
+#define GLSTATECACHE_H
+
+#include "Includes.h"
+
+// Remembers the program, 2D textures and winding last set through it and skips calls that
+// wouldn't change anything. Anything else touching the same state has to be followed by
+// invalidate(), so it's meant to be used for a batch of draws at a time.
+class GLStateCache {
+	private:
+		static const int				MAX_TEXTURE_UNITS = 8;
+
+		// 0 is a real value for all of these, so ~0 marks state that isn't known
+		GLuint							program;
+		GLenum							activeUnit;
+		GLuint							textures[MAX_TEXTURE_UNITS];
+		GLenum							frontFace;
+
+	public:
+		GLStateCache();
+
+		// Forget everything, the next call of each kind always goes to GL
+		void invalidate();
+
+		void useProgram(GLuint newProgram);
+
+		// unit is the index (0 for GL_TEXTURE0), not the enum
+		void bindTexture(int unit, GLuint texture);
+
+		void setFrontFace(GLenum winding);
+};
+#endif
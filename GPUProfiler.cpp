@@ -0,0 +1,149 @@
+#include "GPUProfiler.h"
+#include <iostream>
+
+using namespace std;
+
+GPUProfiler::GPUProfiler() {}
+
+GPUProfiler::~GPUProfiler() {
+	for (Pass &pass : passes) {
+		glDeleteQueries(FRAME_LATENCY, pass.startQueries);
+		glDeleteQueries(FRAME_LATENCY, pass.endQueries);
+	}
+}
+
+GPUProfiler::Pass* GPUProfiler::findPass(const string &name) {
+	for (Pass &pass : passes) {
+		if (pass.name == name)
+			return &pass;
+	}
+
+	// First time this pass is seen, give it its own ring of queries
+	passes.push_back(Pass());
+	Pass *pass = &passes.back();
+	pass->name = name;
+	glGenQueries(FRAME_LATENCY, pass->startQueries);
+	glGenQueries(FRAME_LATENCY, pass->endQueries);
+
+	for (int i = 0; i < FRAME_LATENCY; i++) {
+		pass->issued[i] = false;
+		pass->issuedFrame[i] = 0;
+		pass->cpuMs[i] = 0.0;
+	}
+
+	return pass;
+}
+
+void GPUProfiler::beginFrame() {
+	frameCount++;
+
+	// The slot this frame is about to reuse was last written FRAME_LATENCY frames ago
+	collectResults(frameCount % FRAME_LATENCY);
+}
+
+void GPUProfiler::collectResults(int slot) {
+	vector<PassTiming> results;
+
+	for (Pass &pass : passes) {
+		if (!pass.issued[slot])
+			continue;
+
+		pass.issued[slot] = false;
+
+		// Never wait on the GPU, if it is still this far behind just drop the sample
+		GLint available = 0;
+		glGetQueryObjectiv(pass.endQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			droppedResults++;
+			continue;
+		}
+
+		GLuint64 startTime, endTime;
+		glGetQueryObjectui64v(pass.startQueries[slot], GL_QUERY_RESULT, &startTime);
+		glGetQueryObjectui64v(pass.endQueries[slot], GL_QUERY_RESULT, &endTime);
+
+		PassTiming timing;
+		timing.name = pass.name;
+		timing.frame = pass.issuedFrame[slot];
+		timing.cpuMs = pass.cpuMs[slot];
+		timing.gpuMs = (endTime - startTime) / 1000000.0;
+		results.push_back(timing);
+
+		if (csvFile.is_open())
+			csvFile << timing.frame << "," << timing.name << "," << timing.cpuMs << "," << timing.gpuMs << endl;
+	}
+
+	if (!results.empty())
+		latestResults = results;
+}
+
+void GPUProfiler::beginPass(const string &name) {
+	Pass *pass = findPass(name);
+	int slot = frameCount % FRAME_LATENCY;
+
+	glQueryCounter(pass->startQueries[slot], GL_TIMESTAMP);
+	pass->cpuStart = chrono::high_resolution_clock::now();
+}
+
+void GPUProfiler::endPass(const string &name) {
+	Pass *pass = findPass(name);
+	int slot = frameCount % FRAME_LATENCY;
+
+	glQueryCounter(pass->endQueries[slot], GL_TIMESTAMP);
+	pass->cpuMs[slot] = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - pass->cpuStart).count();
+	pass->issued[slot] = true;
+	pass->issuedFrame[slot] = frameCount;
+}
+
+const vector<GPUProfiler::PassTiming>& GPUProfiler::getLatestResults() {
+	return latestResults;
+}
+
+bool GPUProfiler::getLatestPassTiming(const string &name, PassTiming *timing) {
+	for (const PassTiming &result : latestResults) {
+		if (result.name == name) {
+			*timing = result;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool GPUProfiler::openCSV(const string &path) {
+	csvFile.open(path);
+	if (!csvFile) {
+		cout << "Could not open " << path << " for writing" << endl;
+		return false;
+	}
+
+	csvFile << "frame,pass,cpu_ms,gpu_ms" << endl;
+	return true;
+}
+
+void GPUProfiler::printLatestResults() {
+	if (latestResults.empty())
+		return;
+
+	cout << "Frame " << latestResults[0].frame << ":";
+	for (PassTiming &timing : latestResults)
+		cout << " " << timing.name << " cpu " << timing.cpuMs << " ms gpu " << timing.gpuMs << " ms |";
+
+	if (droppedResults)
+		cout << " (" << droppedResults << " results dropped)";
+	cout << endl;
+}
+
+
+ProfileScope::ProfileScope(GPUProfiler *newProfiler, const string &newName) {
+	profiler = newProfiler;
+	name = newName;
+
+	if (profiler)
+		profiler->beginPass(name);
+}
+
+ProfileScope::~ProfileScope() {
+	if (profiler)
+		profiler->endPass(name);
+}
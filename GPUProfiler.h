@@ -0,0 +1,77 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include "Includes.h"
+#include <fstream>
+#include <vector>
+
+// Times named render passes on both the GPU and the CPU.
+// GPU times come from GL_TIMESTAMP query pairs (so passes can nest). Each pass owns a ring of
+// query objects, one slot per frame in flight, and results are only read back once they are
+// available, so the CPU never waits on the GPU. Results therefore lag a few frames behind.
+class GPUProfiler {
+	public:
+		struct PassTiming {
+			std::string					name;
+			int							frame;
+			double						cpuMs;
+			double						gpuMs;
+		};
+
+	private:
+		// Number of frames a query result is allowed to be in flight for
+		static const int				FRAME_LATENCY = 4;
+
+		struct Pass {
+			std::string					name;
+			GLuint						startQueries[FRAME_LATENCY];
+			GLuint						endQueries[FRAME_LATENCY];
+			bool						issued[FRAME_LATENCY];
+			int							issuedFrame[FRAME_LATENCY];
+			double						cpuMs[FRAME_LATENCY];
+			std::chrono::high_resolution_clock::time_point cpuStart;
+		};
+		std::vector<Pass>				passes;
+
+		int								frameCount = 0;
+
+		// Results of the most recent frame whose queries have all come back
+		std::vector<PassTiming>			latestResults;
+		int								droppedResults = 0;
+
+		std::ofstream					csvFile;
+
+		Pass*							findPass(const std::string &name);
+		void							collectResults(int slot);
+
+	public:
+		GPUProfiler();
+		~GPUProfiler();
+
+		// Call once at the start of every frame, before any passes
+		void beginFrame();
+
+		void beginPass(const std::string &name);
+		void endPass(const std::string &name);
+
+		const std::vector<PassTiming>& getLatestResults();
+
+		// Finds a pass in the latest results, returns false if it wasn't timed in that frame
+		bool getLatestPassTiming(const std::string &name, PassTiming *timing);
+
+		// Writes a row for every pass of every frame as results arrive
+		bool openCSV(const std::string &path);
+		void printLatestResults();
+};
+
+// Times the enclosing scope as a pass, does nothing if the profiler is null
+class ProfileScope {
+	private:
+		GPUProfiler						*profiler;
+		std::string						name;
+
+	public:
+		ProfileScope(GPUProfiler *newProfiler, const std::string &newName);
+		~ProfileScope();
+};
+#endif
@@ -0,0 +1,152 @@
+#include "HeadlessContext.h"
+#include "GLExtensions.h"
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+HeadlessContext::HeadlessContext() {}
+
+HeadlessContext::~HeadlessContext() {
+	destroy();
+}
+
+#ifdef _WIN32
+
+bool HeadlessContext::create() {
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+	// Everything is rendered into FBOs so the window's own framebuffer size doesn't matter
+	hiddenWindow = glfwCreateWindow(1, 1, "Headless", NULL, NULL);
+	if (hiddenWindow == NULL) {
+		cout << "Failed to create hidden GLFW window" << endl;
+		glfwTerminate();
+		return false;
+	}
+
+	glfwMakeContextCurrent(hiddenWindow);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		cout << "Failed to initialize GLAD" << endl;
+		return false;
+	}
+
+	GLExtensions::load((GLADloadproc)glfwGetProcAddress);
+
+	return true;
+}
+
+void HeadlessContext::destroy() {
+	if (hiddenWindow) {
+		glfwDestroyWindow(hiddenWindow);
+		glfwTerminate();
+		hiddenWindow = nullptr;
+	}
+}
+
+#else
+
+// Prefer the Mesa surfaceless platform (no X11/Wayland needed), otherwise use the default display
+EGLDisplay HeadlessContext::openDisplay() {
+	const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+	if (clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+		if (getPlatformDisplay)
+			return getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool HeadlessContext::create() {
+	display = openDisplay();
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+		cout << "Failed to initialize EGL display" << endl;
+		return false;
+	}
+
+	const char *displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+	bool surfaceless = displayExtensions && strstr(displayExtensions, "EGL_KHR_surfaceless_context");
+
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint numConfigs = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+		cout << "Failed to choose an EGL config" << endl;
+		return false;
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+
+	const EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT) {
+		cout << "Failed to create EGL context" << endl;
+		return false;
+	}
+
+	// Everything is rendered into FBOs, the pbuffer only exists for drivers without surfaceless support
+	if (!surfaceless) {
+		const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+	}
+
+	if (!eglMakeCurrent(display, surface, surface, context)) {
+		cout << "Failed to make EGL context current" << endl;
+		return false;
+	}
+
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+		cout << "Failed to initialize GLAD" << endl;
+		return false;
+	}
+
+	GLExtensions::load((GLADloadproc)eglGetProcAddress);
+
+	cout << "Headless context: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << endl;
+	return true;
+}
+
+void HeadlessContext::destroy() {
+	if (display != EGL_NO_DISPLAY) {
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+		if (surface != EGL_NO_SURFACE)
+			eglDestroySurface(display, surface);
+		if (context != EGL_NO_CONTEXT)
+			eglDestroyContext(display, context);
+
+		eglTerminate(display);
+	}
+
+	display = EGL_NO_DISPLAY;
+	context = EGL_NO_CONTEXT;
+	surface = EGL_NO_SURFACE;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+#include "Includes.h"
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// An OpenGL 3.3 core context that isn't attached to a window.
+// On Linux this is an EGL surfaceless context (falling back to a pbuffer), which
+// works on render boxes without a display and on Mesa llvmpipe. Windows has no
+// EGL so an invisible GLFW window is used instead.
+class HeadlessContext {
+	private:
+#ifdef _WIN32
+		GLFWwindow						*hiddenWindow = nullptr;
+#else
+		EGLDisplay						display = EGL_NO_DISPLAY;
+		EGLContext						context = EGL_NO_CONTEXT;
+		EGLSurface						surface = EGL_NO_SURFACE;
+
+		EGLDisplay						openDisplay();
+#endif
+
+	public:
+		HeadlessContext();
+		~HeadlessContext();
+
+		// Creates the context, makes it current and loads the GL function pointers
+		bool create();
+		void destroy();
+};
+#endif
@@ -1,11 +1,41 @@
 #include "HouseScene.h"
 #include "TextureLoader.h"
-#include "ShaderLoader.h"
+#include "GLExtensions.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
 #include <iostream>
 
 using namespace std;
 
-HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
+// The lighting pass reads albedo from unit 0 and these after the light units (see LightClusterer.h)
+static const int GBUFFER_NORMAL_TEXTURE_UNIT = 4;
+static const int GBUFFER_DEPTH_TEXTURE_UNIT = 5;
+
+bool parseShadingPath(const string &name, ShadingPath *path) {
+	if (name == "forward")
+		*path = SHADING_FORWARD;
+	else if (name == "deferred")
+		*path = SHADING_DEFERRED;
+	else
+		return false;
+
+	return true;
+}
+
+const char *shadingPathName(ShadingPath path) {
+	switch (path) {
+		case SHADING_FORWARD:
+			return "forward";
+		case SHADING_DEFERRED:
+			return "deferred";
+	}
+
+	return "unknown";
+}
+
+HouseScene::HouseScene(int newWidth, int newHeight, int sampleSize) {
+	samples = sampleSize;
 	screenWidth = newWidth * samples;
 	screenHeight = newHeight * samples;
 
@@ -15,14 +45,21 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 
 
 	skySphereModel = new Sphere(32, 16, 30.0f, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), CG_RIGHTHANDED);
-	lightSphereModel = new Sphere(16, 8, 0.2f, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), CG_RIGHTHANDED);
+	lightSphereInstances = new InstancedMesh(0.2f, 16, 8);
 
-	houseModel =  new Model("Resources\\Models\\house\\house.obj");
-	landModel = new Model("Resources\\Models\\land\\land.obj");
-	torchModel = new Model("Resources\\Models\\torch\\torch.obj");
-	doorModel = new Model("Resources\\Models\\door\\door.obj");
-	ceilingLightModel = new Model("Resources\\Models\\ceilingLight\\ceilingLight.obj");
-	fenceModel = new Model("Resources\\Models\\fence\\fence.obj");
+	houseModel =  new Model("Resources/Models/house/house.obj");
+	landModel = new Model("Resources/Models/land/land.obj");
+	torchModel = new Model("Resources/Models/torch/torch.obj");
+	doorModel = new Model("Resources/Models/door/door.obj");
+	ceilingLightModel = new Model("Resources/Models/ceilingLight/ceilingLight.obj");
+	fenceModel = new Model("Resources/Models/fence/fence.obj");
+
+	fenceInstances = new InstancedMesh("Resources/Models/fence/fence.obj");
+	torchInstances = new InstancedMesh("Resources/Models/torch/torch.obj");
+
+	occlusionCuller = new OcclusionCuller();
+	softwareOcclusion = new SoftwareOcclusion(256, 144);
+	setupTransforms();
 
 	// Instanciate the camera object with basic data
 	earthCamera = new Camera(camera_settings, glm::vec3(13.0, 5.0, 0.0), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), -180.0, -10.0);
@@ -31,13 +68,13 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 	// Setup textures for rendering the Earth model
 	//
 
-	skySphereTexture = TextureLoader::loadTexture(string("Resources\\Models\\sky.bmp"));
-	houseTexture = TextureLoader::loadTexture(string("Resources\\Models\\house\\house.bmp"));
-	landTexture = TextureLoader::loadTexture(string("Resources\\Models\\land\\land.bmp"));
-	torchTexture = TextureLoader::loadTexture(string("Resources\\Models\\torch\\torch.bmp"));
-	doorTexture = TextureLoader::loadTexture(string("Resources\\Models\\door\\door.bmp"));
-	ceilingLightTexture = TextureLoader::loadTexture(string("Resources\\Models\\ceilingLight\\ceilingLight.bmp"));
-	fenceTexture = TextureLoader::loadTexture(string("Resources\\Models\\fence\\fence.bmp"));
+	skySphereTexture = TextureLoader::loadTexture(string("Resources/Models/sky.bmp"));
+	houseTexture = TextureLoader::loadTexture(string("Resources/Models/house/house.bmp"));
+	landTexture = TextureLoader::loadTexture(string("Resources/Models/land/land.bmp"));
+	torchTexture = TextureLoader::loadTexture(string("Resources/Models/torch/torch.bmp"));
+	doorTexture = TextureLoader::loadTexture(string("Resources/Models/door/door.bmp"));
+	ceilingLightTexture = TextureLoader::loadTexture(string("Resources/Models/ceilingLight/ceilingLight.bmp"));
+	fenceTexture = TextureLoader::loadTexture(string("Resources/Models/fence/fence.bmp"));
 
 	textures.push_back(&skySphereTexture);
 	textures.push_back(&houseTexture);
@@ -46,21 +83,6 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 	textures.push_back(&doorTexture);
 	textures.push_back(&fenceTexture);
 
-	GLSL_ERROR glsl_err = ShaderLoader::createShaderProgram(
-		string("Resources\\Shaders\\Phong_shader.vert"),
-		string("Resources\\Shaders\\Phong_shader.frag"),
-		&phongShader);
-
-	
-	// Setup uniform locations for shader
-	modelTextureUniform = glGetUniformLocation(phongShader, "texture0");
-
-	modelMatrixLocation = glGetUniformLocation(phongShader, "modelMatrix");
-
-	invTransposeMatrixLocation = glGetUniformLocation(phongShader, "invTransposeModelMatrix");
-
-	viewProjectionMatrixLocation = glGetUniformLocation(phongShader, "viewProjectionMatrix");
-
 	//the sun
 	dirLightParams.push_back(DirecionalLightParams());
 	dirLightParams.back().direction = glm::vec4(12.0f, 12.0f, 0.0f, 0.0f);
@@ -68,7 +90,6 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 	dirLightParams.back().specular = glm::vec4(0.0005f, 0.0005f, 0.0005f, 1.0f);
 	dirLightParams.back().ambient = glm::vec4(0.3f, 0.3f, 0.3f, 1.0f);
 	dirLightParams.back().exponent = 0.1f;
-	setupLight(&dirLightParams.back());
 
 	//left torch light
 	pointLightParams.push_back(PointLightParams());
@@ -78,7 +99,6 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 	pointLightParams.back().ambient = glm::vec4(0.9412f, 0.3765f, 0.0f, 1.0f);
 	pointLightParams.back().exponent = 1.0f;
 	pointLightParams.back().attenuation = glm::vec3(1.0, 0.35, 0.44);
-	setupLight(&pointLightParams.back());
 
 	//right torch light
 	pointLightParams.push_back(PointLightParams());
@@ -88,7 +108,6 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 	pointLightParams.back().ambient = glm::vec4(0.9412f, 0.3765f, 0.0f, 1.0f);
 	pointLightParams.back().exponent = 1.0f;
 	pointLightParams.back().attenuation = glm::vec3(1.0, 0.35, 0.44);
-	setupLight(&pointLightParams.back());
 
 	//house light
 	pointLightParams.push_back(PointLightParams());
@@ -98,16 +117,94 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 	pointLightParams.back().ambient = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 	pointLightParams.back().exponent = 1.0f;
 	pointLightParams.back().attenuation = glm::vec3(1.0, 0.7, 2.0);
-	setupLight(&pointLightParams.back());
 
-	cameraPosLocation = glGetUniformLocation(phongShader, "cameraPos");
-	// Set constant uniform data (uniforms that will not change while the application is running)
-	// Note: Remember we need to bind the shader before we can set uniform variables!
-	glUseProgram(phongShader);
-	glUniform1i(modelTextureUniform, 0);
+	sceneLightCount = (int)pointLightParams.size();
+
+	// The variants of the path that renders first are asked for now so the driver can get on with them
+	// while the rest is set up, the other path's wait until setShadingPath() switches to it
+	requestScenePrograms(isDeferred());
+
+	const GLubyte white[4] = { 255, 255, 255, 255 };
+	glGenTextures(1, &whiteTexture);
+	glBindTexture(GL_TEXTURE_2D, whiteTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	ShaderVariants::Defines lightingDefines;
+	lightingDefines["NUM_OF_DIR_LIGHTS"] = NUM_OF_DIR_LIGHTS;
+	deferredLightingShader = shaderVariants.get("Resources/Shaders/Resolve_shader.vert", "Resources/Shaders/DeferredLighting_shader.frag", lightingDefines);
+
+	deferredCameraPosLocation = glGetUniformLocation(deferredLightingShader, "cameraPos");
+	inverseViewProjectionLocation = glGetUniformLocation(deferredLightingShader, "inverseViewProjection");
+	viewportSizeLocation = glGetUniformLocation(deferredLightingShader, "viewportSize");
+
+	glUseProgram(deferredLightingShader);
+	glUniform1i(glGetUniformLocation(deferredLightingShader, "albedoTexture"), 0);
+	glUniform1i(glGetUniformLocation(deferredLightingShader, "normalTexture"), GBUFFER_NORMAL_TEXTURE_UNIT);
+	glUniform1i(glGetUniformLocation(deferredLightingShader, "depthTexture"), GBUFFER_DEPTH_TEXTURE_UNIT);
+	glUseProgram(0);
+
+	// Light data is sized for the shader's arrays up front and filled in by uploadLights() before the first render
+	GLint lightBlockSize = sizeof(DirecionalLightParams) * NUM_OF_DIR_LIGHTS;
+	glGenBuffers(1, &lightUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+	glBufferData(GL_UNIFORM_BUFFER, lightBlockSize, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// The deferred lighting pass reads the same light buffer as the forward variants
+	GLuint lightBlockIndex = glGetUniformBlockIndex(deferredLightingShader, "Lights");
+	if (lightBlockIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(deferredLightingShader, lightBlockIndex, LIGHT_BLOCK_BINDING);
+	LightClusterer::setupProgram(deferredLightingShader);
+
+	// Point lights can be any number so they're in a buffer texture, resized by uploadLights()
+	glGenBuffers(1, &pointLightBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, pointLightBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(PointLightParams), NULL, GL_DYNAMIC_DRAW);
+
+	glGenTextures(1, &pointLightTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, pointLightTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, pointLightBuffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	lightClusterer = new LightClusterer();
+
+	// Shader for resolving the multisampled target (MSAA mode)
+	ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/MSAAResolve_shader.frag"),
+		&msaaResolveShader);
+
+	msaaSamplesLocation = glGetUniformLocation(msaaResolveShader, "samples");
+	glUseProgram(msaaResolveShader);
+	glUniform1i(glGetUniformLocation(msaaResolveShader, "texture0"), 0);
 	glUseProgram(0);
 
+	glGenVertexArrays(1, &emptyVAO);
 
+	setupFBO();
+}
+
+HouseScene::~HouseScene() {
+	deleteFBO();
+	glDeleteBuffers(1, &lightUBO);
+	glDeleteBuffers(1, &pointLightBuffer);
+	glDeleteTextures(1, &pointLightTexture);
+	glDeleteTextures(1, &whiteTexture);
+
+	delete fenceInstances;
+	delete torchInstances;
+	delete lightSphereInstances;
+	delete occlusionCuller;
+	delete softwareOcclusion;
+	delete lightClusterer;
+}
+
+// Creates the FBO and the textures it renders into at the current screenWidth x screenHeight
+void HouseScene::setupFBO() {
 	//
 	// Setup FBO (which Earth rendering pass will draw into)
 	//
@@ -136,9 +233,10 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 
 	// Setup depth texture
 
+	// Has a stencil channel so passes can be limited to some of the pixels (adaptive supersampling)
 	glGenTextures(1, &fboDepthTexture);
 	glBindTexture(GL_TEXTURE_2D, fboDepthTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, screenWidth, screenHeight, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, screenWidth, screenHeight, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -158,10 +256,10 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 		fboColourTexture,
 		0);
 
-	// Attach the depth texture object to the framebuffer object's depth attachment point
+	// Attach the depth texture object to the framebuffer object's depth and stencil attachment point
 	glFramebufferTexture2D(
 		GL_FRAMEBUFFER,
-		GL_DEPTH_ATTACHMENT,
+		GL_DEPTH_STENCIL_ATTACHMENT,
 		GL_TEXTURE_2D,
 		fboDepthTexture,
 		0);
@@ -188,9 +286,304 @@ HouseScene::HouseScene(int newWidth, int newHeight, int samples) {
 
 	// Unbind FBO for now! (Plug main framebuffer back in as rendering destination)
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (msaaSamples > 1)
+		setupMSAAFBO();
+	else if (shadingPath == SHADING_DEFERRED)
+		setupGBuffer();
+}
+
+// The scene is drawn into this FBO in MSAA mode and then resolved into demoFBO's colour texture
+void HouseScene::setupMSAAFBO() {
+	glGenFramebuffers(1, &msaaFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, msaaFBO);
+
+	// Colour is a multisample texture so the shader resolve can read individual samples
+	glGenTextures(1, &msaaColourTexture);
+	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, msaaColourTexture);
+	glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, msaaSamples, GL_RGBA8, screenWidth, screenHeight, GL_TRUE);
+	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+
+	// Depth is never read back so a renderbuffer is enough
+	glGenRenderbuffers(1, &msaaDepthRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, msaaDepthRenderbuffer);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, msaaSamples, GL_DEPTH_COMPONENT24, screenWidth, screenHeight);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, msaaColourTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, msaaDepthRenderbuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		fboOkay = false;
+		cout << "Could not successfully create multisampled framebuffer object!" << endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Deferred shading draws into this FBO, then lights it into demoFBO's colour texture
+void HouseScene::setupGBuffer() {
+	glGenFramebuffers(1, &gBufferFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, gBufferFBO);
+
+	// Texture colour, world space normal (10 bits a component is plenty for lighting) and window depth.
+	// Depth gets its own float target because the lighting pass can't sample fboDepthTexture
+	// while it's attached to demoFBO.
+	GLint formats[] = { GL_RGBA8, GL_RGB10_A2, GL_R32F };
+	GLenum pixelFormats[] = { GL_RGBA, GL_RGBA, GL_RED };
+	GLenum pixelTypes[] = { GL_UNSIGNED_BYTE, GL_UNSIGNED_BYTE, GL_FLOAT };
+	GLuint *targets[] = { &gBufferAlbedoTexture, &gBufferNormalTexture, &gBufferDepthTexture };
+
+	for (int i = 0; i < 3; i++) {
+		glGenTextures(1, targets[i]);
+		glBindTexture(GL_TEXTURE_2D, *targets[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, formats[i], screenWidth, screenHeight, 0, pixelFormats[i], pixelTypes[i], NULL);
+
+		// Only ever read with texelFetch
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, *targets[i], 0);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, fboDepthTexture, 0);
+
+	GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, drawBuffers);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		fboOkay = false;
+		cout << "Could not successfully create the G-buffer!" << endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void HouseScene::deleteFBO() {
+	glDeleteFramebuffers(1, &demoFBO);
+	glDeleteTextures(1, &fboColourTexture);
+	glDeleteTextures(1, &fboDepthTexture);
+
+	if (msaaFBO) {
+		glDeleteFramebuffers(1, &msaaFBO);
+		glDeleteTextures(1, &msaaColourTexture);
+		glDeleteRenderbuffers(1, &msaaDepthRenderbuffer);
+		msaaFBO = 0;
+	}
+
+	if (gBufferFBO) {
+		glDeleteFramebuffers(1, &gBufferFBO);
+		glDeleteTextures(1, &gBufferAlbedoTexture);
+		glDeleteTextures(1, &gBufferNormalTexture);
+		glDeleteTextures(1, &gBufferDepthTexture);
+		gBufferFBO = 0;
+	}
+
+	fboOkay = false;
+}
+
+void HouseScene::setMSAAOptions(bool perSampleShading, MSAAResolveMode resolveMode) {
+	sampleShading = perSampleShading;
+	msaaResolveMode = resolveMode;
+}
+
+int HouseScene::getMSAASamples() {
+
+	return msaaSamples;
+}
+
+void HouseScene::setShadingPath(ShadingPath path) {
+	if (path == shadingPath)
+		return;
+
+	deleteFBO();
+	shadingPath = path;
+	setupFBO();
+
+	// Already requested variants are only looked up
+	requestScenePrograms(path == SHADING_DEFERRED);
+}
+
+ShadingPath HouseScene::getShadingPath() {
+
+	return shadingPath;
+}
+
+bool HouseScene::isDeferred() {
+
+	return shadingPath == SHADING_DEFERRED && msaaSamples == 1;
+}
+
+void HouseScene::resolveMSAA() {
+	if (msaaResolveMode == MSAA_RESOLVE_BLIT) {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, msaaFBO);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, demoFBO);
+		glBlitFramebuffer(0, 0, screenWidth, screenHeight, 0, 0, screenWidth, screenHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	} else {
+		glBindFramebuffer(GL_FRAMEBUFFER, demoFBO);
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+
+		glUseProgram(msaaResolveShader);
+		glUniform1i(msaaSamplesLocation, msaaSamples);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, msaaColourTexture);
+
+		glBindVertexArray(emptyVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glBindVertexArray(0);
+
+		glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+		glUseProgram(0);
+
+		glEnable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+	}
+}
+
+void HouseScene::clearViewport(GLbitfield buffers, int viewportWidth, int viewportHeight) {
+	// Under dynamic resolution the viewport can be a small corner of the FBO, clearing the rest
+	// would cost as much as rendering at the largest scale
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(0, 0, viewportWidth, viewportHeight);
+	glClear(buffers);
+	glDisable(GL_SCISSOR_TEST);
+}
+
+void HouseScene::lightGBuffer(const glm::mat4 &viewProjection, int viewportWidth, int viewportHeight) {
+	glBindFramebuffer(GL_FRAMEBUFFER, demoFBO);
+
+	// Pixels nothing was drawn on are discarded by the shader, so they're left cleared. Clearing
+	// ignores the stencil test, drawing doesn't, so adaptive supersampling still only lights its pixels.
+	clearViewport(GL_COLOR_BUFFER_BIT, viewportWidth, viewportHeight);
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glUseProgram(deferredLightingShader);
+
+	glm::vec3 cameraPos = earthCamera->getCameraPosition();
+	glUniform3fv(deferredCameraPosLocation, 1, (GLfloat*)&cameraPos);
+	glUniformMatrix4fv(inverseViewProjectionLocation, 1, GL_FALSE, glm::value_ptr(glm::inverse(viewProjection)));
+	glUniform2f(viewportSizeLocation, (float)viewportWidth, (float)viewportHeight);
+
+	// The light buffer textures and uniform blocks are still bound from the start of render()
+	glActiveTexture(GL_TEXTURE0 + GBUFFER_NORMAL_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, gBufferNormalTexture);
+	glActiveTexture(GL_TEXTURE0 + GBUFFER_DEPTH_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, gBufferDepthTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, gBufferAlbedoTexture);
+
+	glBindVertexArray(emptyVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glUseProgram(0);
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+}
+
+// Reallocates only the render targets for a new output size or supersampling factor.
+// Models, textures and shaders are left as they are so this is cheap enough to do at runtime.
+void HouseScene::updateScene(int newWidth, int newHeight, int sampleSize, int newMSAASamples) {
+	samples = sampleSize;
+
+	GLint maxSamples;
+	glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+	newMSAASamples = max(1, min(newMSAASamples, (int)maxSamples));
+
+	int fullWidth = newWidth * sampleSize;
+	int fullHeight = newHeight * sampleSize;
+
+	// The camera's aspect ratio always comes from the whole image, even when rendering it in tiles
+	earthCamera->updateScreenSize(fullWidth, fullHeight);
+
+	// Tiled rendering only needs a target the size of one tile
+	int fboWidth = tileSize > 0 ? min(tileSize, fullWidth) : fullWidth;
+	int fboHeight = tileSize > 0 ? min(tileSize, fullHeight) : fullHeight;
+
+	if (fboWidth == screenWidth && fboHeight == screenHeight && newMSAASamples == msaaSamples)
+		return;
+
+	deleteFBO();
+
+	screenWidth = fboWidth;
+	screenHeight = fboHeight;
+	msaaSamples = newMSAASamples;
+
+	setupFBO();
+}
+
+void HouseScene::setFenceRings(int rings) {
+
+	fenceRings = max(rings, 1);
+	updateFenceTransforms();
+}
+
+// Torches on a sunflower spiral outside the fence, so they're spread evenly however many there are
+void HouseScene::setExtraLights(int count) {
+	extraLights = max(count, 0);
+	pointLightParams.resize(sceneLightCount);
+
+	for (int i = 0; i < extraLights; i++) {
+		float angle = i * 2.39996f;
+		float distance = 6.0f + 0.6f * sqrt((float)i);
+
+		pointLightParams.push_back(PointLightParams());
+		pointLightParams.back().position = glm::vec4(cos(angle) * distance, 1.7f, sin(angle) * distance, 0.0f);
+		pointLightParams.back().diffuse = glm::vec4(1.8824f, 0.7530f, 0.0f, 1.0f);
+		pointLightParams.back().specular = glm::vec4(0.5f, 0.2f, 0.0f, 1.0f);
+		pointLightParams.back().ambient = glm::vec4(0.02f, 0.01f, 0.0f, 1.0f);
+		pointLightParams.back().exponent = 1.0f;
+		pointLightParams.back().attenuation = glm::vec3(1.0, 1.0, 20.0);
+	}
+
+	lightsDirty = true;
+}
+
+int HouseScene::getPointLightCount() {
+
+	return (int)pointLightParams.size();
+}
+
+void HouseScene::setLightClustering(bool enabled) {
+	lightClustering = enabled;
+
+	if (lightClustering)
+		lightClusterer->setGridSize(LightClusterer::DEFAULT_CLUSTERS_X, LightClusterer::DEFAULT_CLUSTERS_Y, LightClusterer::DEFAULT_CLUSTERS_Z);
+	else
+		lightClusterer->setGridSize(1, 1, 1);
+}
+
+bool HouseScene::getLightClustering() {
+
+	return lightClustering;
+}
+
+float HouseScene::getLightBinMs() {
+
+	return lightClusterer->getLastBinMs();
+}
+
+float HouseScene::getLightsPerCluster() {
+
+	return lightClusterer->getAverageLightsPerCluster();
 }
 
-HouseScene::~HouseScene() {}
+void HouseScene::setTileSize(int newTileSize) {
+
+	tileSize = newTileSize;
+}
+
+int HouseScene::getSampleSize() {
+
+	return samples;
+}
 
 // Accessor methods
 Camera* HouseScene::getHouseSceneCamera() {
@@ -204,6 +597,68 @@ GLuint HouseScene::getHouseSceneTexture() {
 	return fboColourTexture;
 }
 
+// Only holds the scene's depth when MSAA is off, the multisampled target uses a renderbuffer
+GLuint HouseScene::getHouseSceneDepthTexture() {
+
+	return fboDepthTexture;
+}
+
+// The single sampled target the scene ends up in, after any MSAA resolve
+GLuint HouseScene::getHouseSceneFramebuffer() {
+
+	return demoFBO;
+}
+
+int HouseScene::getShaderVariantCount() {
+
+	return shaderVariants.getVariantCount();
+}
+
+int HouseScene::getPendingShaderCount() {
+
+	return shaderVariants.getPendingCount();
+}
+
+void HouseScene::finishShaders() {
+	shaderVariants.finish();
+}
+
+
+void HouseScene::setOcclusionCulling(bool enabled) {
+
+	occlusionCulling = enabled;
+}
+
+bool HouseScene::getOcclusionCulling() {
+
+	return occlusionCulling;
+}
+
+void HouseScene::setSoftwareOcclusion(bool enabled) {
+
+	softwareOcclusionCulling = enabled;
+}
+
+bool HouseScene::getSoftwareOcclusion() {
+
+	return softwareOcclusionCulling;
+}
+
+int HouseScene::getOccludedCount() {
+
+	return occludedCount;
+}
+
+int HouseScene::getDrawnCount() {
+
+	return drawnCount;
+}
+
+int HouseScene::getCulledCount() {
+
+	return culledCount;
+}
+
 
 float HouseScene::getSunTheta() {
 
@@ -247,7 +702,7 @@ void HouseScene::update(const float timeDelta) {
 
 		pointLightParams[2].ambient = colour;
 		pointLightParams[2].diffuse = colour;
-		updateLight(POINT, 2);
+		lightsDirty = true;
 
 		if (num < 2)
 			num++;
@@ -256,218 +711,459 @@ void HouseScene::update(const float timeDelta) {
 	}
 }
 
-void HouseScene::setupLight(DirecionalLightParams* lp) {
-	dirLightUniforms.push_back(DirectionalLightUniforms());
+// Copies the directional lights into the uniform buffer and the point lights into their buffer texture,
+// directional lights the shader has no room for are dropped
+void HouseScene::uploadLights() {
+	static_assert(sizeof(DirecionalLightParams) == 80 && sizeof(PointLightParams) == 80, "light structs must match Phong_shader.frag");
+
+	size_t dirCount = min(dirLightParams.size(), (size_t)NUM_OF_DIR_LIGHTS);
+
+	// Unused slots are zeroed so they add no light
+	vector<char> block(sizeof(DirecionalLightParams) * NUM_OF_DIR_LIGHTS, 0);
+	if (dirCount > 0)
+		memcpy(block.data(), dirLightParams.data(), sizeof(DirecionalLightParams) * dirCount);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, block.size(), block.data());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// Buffer textures can't be empty, but no cluster points at a light that isn't there
+	glBindBuffer(GL_TEXTURE_BUFFER, pointLightBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(PointLightParams) * max(pointLightParams.size(), (size_t)1), NULL, GL_DYNAMIC_DRAW);
+	if (!pointLightParams.empty())
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(PointLightParams) * pointLightParams.size(), pointLightParams.data());
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	vector<glm::vec3> positions;
+	vector<float> radii;
+	for (const PointLightParams &light : pointLightParams) {
+		positions.push_back(glm::vec3(light.position));
+		radii.push_back(lightRadius(light));
+	}
+	lightClusterer->setLights(positions, radii);
 
-	int lightNum = dirLightParams.size() - 1;
-	char buffer[64];
+	// A sphere is drawn on the origin point of each light
+	vector<glm::mat4> sphereTransforms;
+	for (const DirecionalLightParams &light : dirLightParams)
+		sphereTransforms.push_back(glm::translate(glm::mat4(1.0), glm::vec3(light.direction)));
+	for (const PointLightParams &light : pointLightParams)
+		sphereTransforms.push_back(glm::translate(glm::mat4(1.0), glm::vec3(light.position)));
+	lightSphereInstances->setInstances(sphereTransforms);
 
-	sprintf_s(buffer, "dirLight[%i].lightDirection", lightNum);
-	dirLightUniforms.back().directionLocation = glGetUniformLocation(phongShader, buffer);
+	lightsDirty = false;
+}
 
-	sprintf_s(buffer, "dirLight[%i].lightDiffuseColour", lightNum);
-	dirLightUniforms.back().diffuseLocation = glGetUniformLocation(phongShader, buffer);
+// Solves attenuation(d) = brightest * 256 for d. The ambient term isn't lambertian so it counts too.
+float HouseScene::lightRadius(const PointLightParams &light) {
+	glm::vec4 total = light.ambient + light.diffuse + light.specular;
+	float brightest = max(total.x, max(total.y, total.z));
 
-	sprintf_s(buffer, "dirLight[%i].lightSpecularColour", lightNum);
-	dirLightUniforms.back().specularLocation = glGetUniformLocation(phongShader, buffer);
+	float constant = light.attenuation.x - brightest * 256.0f;
+	float linear = light.attenuation.y;
+	float quadratic = light.attenuation.z;
 
-	sprintf_s(buffer, "dirLight[%i].lightAmbientColour", lightNum);
-	dirLightUniforms.back().ambientLocation = glGetUniformLocation(phongShader, buffer);
+	// Never bright enough to matter
+	if (constant >= 0.0f)
+		return 0.0f;
 
-	sprintf_s(buffer, "dirLight[%i].lightSpecularExponent", lightNum);
-	dirLightUniforms.back().specExpLocation = glGetUniformLocation(phongShader, buffer);
+	if (quadratic > 0.0f)
+		return (-linear + sqrt(linear * linear - 4.0f * quadratic * constant)) / (2.0f * quadratic);
+	if (linear > 0.0f)
+		return -constant / linear;
 
-	glUseProgram(phongShader);
-	glUniform4f(dirLightUniforms.back().directionLocation, lp->direction.x, lp->direction.y, lp->direction.z, lp->direction.w); // world coordinate space vector
-	glUniform4f(dirLightUniforms.back().diffuseLocation, lp->diffuse.x, lp->diffuse.y, lp->diffuse.z, lp->diffuse.w); // white diffuse light
-	glUniform4f(dirLightUniforms.back().specularLocation, lp->specular.x, lp->specular.y, lp->specular.z, lp->specular.w); // white specular light
-	glUniform4f(dirLightUniforms.back().ambientLocation, lp->ambient.x, lp->ambient.y, lp->ambient.z, lp->ambient.w); // ambient light
-	glUniform1f(dirLightUniforms.back().specExpLocation, lp->exponent); // specular exponent / falloff
-	glUseProgram(0);
+	// No falloff, it reaches everything
+	return FLT_MAX;
 }
 
-void HouseScene::setupLight(PointLightParams* lp)
-{
-	pointLightUniforms.push_back(PointLightUniforms());
+// The fence is 15 segments around the house, extra rings are scaled out from the centre
+vector<glm::mat4> HouseScene::fenceTransforms() {
+	vector<glm::mat4> transforms;
 
-	int lightNum = pointLightParams.size() - 1;
-	char buffer[64];
+	for (int ring = 0; ring < fenceRings; ring++) {
+		float scale = 1.0f + ring * 0.25f;
 
-	sprintf_s(buffer, "pointLight[%i].lightPosition", lightNum);
-	pointLightUniforms.back().directionLocation = glGetUniformLocation(phongShader, buffer);
+		for (int i = 0; i < 15; i++) {
+			glm::mat4 modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(0.0f, -0.5f, 0.0f));
+			modelTransform = glm::scale(modelTransform, glm::vec3(scale, 1.0f, scale));
+			modelTransform = glm::rotate(modelTransform, ((i * 17.0f) - 210.0f) * (3.1459f / 180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			transforms.push_back(modelTransform);
+		}
+	}
 
-	sprintf_s(buffer, "pointLight[%i].lightDiffuseColour", lightNum);
-	pointLightUniforms.back().diffuseLocation = glGetUniformLocation(phongShader, buffer);
+	return transforms;
+}
 
-	sprintf_s(buffer, "pointLight[%i].lightSpecularColour", lightNum);
-	pointLightUniforms.back().specularLocation = glGetUniformLocation(phongShader, buffer);
+// None of the scene's objects move, so everything is placed once here
+void HouseScene::setupTransforms() {
+	glm::mat4 modelTransform;
 
-	sprintf_s(buffer, "pointLight[%i].lightAmbientColour", lightNum);
-	pointLightUniforms.back().ambientLocation = glGetUniformLocation(phongShader, buffer);
+	// The camera is always inside the sky so it's never culled
+	skyTransformID = transforms.add(glm::mat4(1.0));
 
-	sprintf_s(buffer, "pointLight[%i].lightSpecularExponent", lightNum);
-	pointLightUniforms.back().specExpLocation = glGetUniformLocation(phongShader, buffer);
+	houseTransformID = transforms.add(glm::mat4(1.0), BoundingBox::fromModel(houseModel));
 
-	sprintf_s(buffer, "pointLight[%i].lightAttenuation", lightNum);
-	pointLightUniforms.back().attenuation = glGetUniformLocation(phongShader, buffer);
+	modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(1.65f, 0.0f, -1.9f));
+	modelTransform = glm::rotate(modelTransform, -50.0f * (3.1459f / 180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	doorTransformID = transforms.add(modelTransform, BoundingBox::fromModel(doorModel));
 
-	glUseProgram(phongShader);
-	glUniform4f(pointLightUniforms.back().directionLocation, lp->position.x, lp->position.y, lp->position.z, lp->position.w); // world coordinate space vector
-	glUniform4f(pointLightUniforms.back().diffuseLocation, lp->diffuse.x, lp->diffuse.y, lp->diffuse.z, lp->diffuse.w); // white diffuse light
-	glUniform4f(pointLightUniforms.back().specularLocation, lp->specular.x, lp->specular.y, lp->specular.z, lp->specular.w); // white specular light
-	glUniform4f(pointLightUniforms.back().ambientLocation, lp->ambient.x, lp->ambient.y, lp->ambient.z, lp->ambient.w); // ambient light
-	glUniform1f(pointLightUniforms.back().specExpLocation, lp->exponent); // specular exponent / falloff
-	glUniform3f(pointLightUniforms.back().attenuation, lp->attenuation.x, lp->attenuation.y, lp->attenuation.z); // attenuation
-	glUseProgram(0);
+	landTransformID = transforms.add(glm::translate(glm::mat4(1.0), glm::vec3(0.0f, -0.5f, 0.0f)), BoundingBox::fromModel(landModel));
+
+	ceilingLightTransformID = transforms.add(glm::translate(glm::mat4(1.0), glm::vec3(-4.6f, 0.3f, 0.0f)), BoundingBox::fromModel(ceilingLightModel));
+
+	// The ceiling light is hidden inside the house from most places outside it
+	occlusionIDs.resize(ceilingLightTransformID + 1, -1);
+	int occludees[] = { houseTransformID, doorTransformID, landTransformID, ceilingLightTransformID };
+	for (int transformID : occludees)
+		occlusionIDs[transformID] = occlusionCuller->add();
+
+	// The two big closed meshes hide most of what's behind them, the rest are too small to bother
+	softwareOcclusion->addOccluder(houseModel, transforms.getModelMatrix(houseTransformID));
+	softwareOcclusion->addOccluder(landModel, transforms.getModelMatrix(landTransformID));
+
+	// Fence and torch transforms are only drawn one at a time if they couldn't be loaded for
+	// instancing, and then there are no bounds for them either
+
+	vector<glm::mat4> torches = torchTransforms();
+	torchInstances->setInstances(torches);
+	for (const glm::mat4 &torchTransform : torches)
+		torchTransformIDs.push_back(transforms.add(torchTransform));
+
+	updateFenceTransforms();
 }
 
-void HouseScene::updateLight(LightType type, int lightID)
-{
-	if (type == POINT) {
-		PointLightUniforms* curLight = &pointLightUniforms[lightID];
-		PointLightParams* lp = &pointLightParams[lightID];
+void HouseScene::updateFenceTransforms() {
+	vector<glm::mat4> fences = fenceTransforms();
+	fenceInstances->setInstances(fences);
 
-		glUseProgram(phongShader);
-		glUniform4f(curLight->directionLocation, lp->position.x, lp->position.y, lp->position.z, lp->position.w); // world coordinate space vector
-		glUniform4f(curLight->diffuseLocation, lp->diffuse.x, lp->diffuse.y, lp->diffuse.z, lp->diffuse.w); // white diffuse light
-		glUniform4f(curLight->specularLocation, lp->specular.x, lp->specular.y, lp->specular.z, lp->specular.w); // white specular light
-		glUniform4f(curLight->ambientLocation, lp->ambient.x, lp->ambient.y, lp->ambient.z, lp->ambient.w); // ambient light
-		glUniform1f(curLight->specExpLocation, lp->exponent); // specular exponent / falloff
-		glUniform3f(curLight->attenuation, lp->attenuation.x, lp->attenuation.y, lp->attenuation.z); // attenuation
-		glUseProgram(0);
+	for (size_t i = 0; i < fences.size(); i++) {
+		if (i < fenceTransformIDs.size())
+			transforms.set(fenceTransformIDs[i], fences[i]);
+		else
+			fenceTransformIDs.push_back(transforms.add(fences[i]));
 	}
 }
 
-void HouseScene::renderModel(Model* newModel, glm::mat4* transform, glm::mat4* T, GLuint* newTexture, int frontFace) {
-	if (newModel) {
-		// Calculate inverse transpose of the modelling transform for correct transformation of normal vectors
-		glm::mat4 inverseTranspose = glm::transpose(glm::inverse(*transform));
+vector<glm::mat4> HouseScene::torchTransforms() {
+	vector<glm::mat4> transforms;
 
-		glUseProgram(phongShader);
+	for (int i = 0; i < 2; i++)
+		transforms.push_back(glm::translate(glm::mat4(1.0), glm::vec3(0.0f, -0.5f, i * 4)));
 
-		// Get the location of the camera in world coords and set the corresponding uniform in the shader
-		glm::vec3 cameraPos = earthCamera->getCameraPosition();
-		glUniform3fv(cameraPosLocation, 1, (GLfloat*)&cameraPos);
+	return transforms;
+}
 
-		// Set the model, view and projection matrix uniforms (from the camera data obtained above)
-		glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(*transform));
-		glUniformMatrix4fv(invTransposeMatrixLocation, 1, GL_FALSE, glm::value_ptr(inverseTranspose));
-		glUniformMatrix4fv(viewProjectionMatrixLocation, 1, GL_FALSE, glm::value_ptr(*T));
+void HouseScene::sceneProgramSource(bool deferred, bool instanced, int surface, string *vertexPath, string *fragmentPath, ShaderVariants::Defines *defines) {
+	if (!(surface & SURFACE_TEXTURED))
+		(*defines)["UNTEXTURED"] = 1;
+	if (!(surface & SURFACE_SPECULAR))
+		(*defines)["NO_SPECULAR"] = 1;
 
-		// Activate and Bind the textures to texture units
-		if (newTexture) {
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, *newTexture);
-		}
+	// The G-buffer shader has no lights, leaving the count out lets the variants share more
+	if (!deferred)
+		(*defines)["NUM_OF_DIR_LIGHTS"] = NUM_OF_DIR_LIGHTS;
 
-		//Render the model
-		glFrontFace(frontFace);
-		newModel->render();
-		glFrontFace(frontFace);
+	*vertexPath = instanced ? "Resources/Shaders/PhongInstanced_shader.vert" : "Resources/Shaders/Phong_shader.vert";
+	*fragmentPath = deferred ? "Resources/Shaders/GBuffer_shader.frag" : "Resources/Shaders/Phong_shader.frag";
+}
 
-		// Restore default OpenGL shaders (Fixed function operations)
-		glUseProgram(0);
+// Starts building every Phong or G-buffer variant without waiting, sceneProgram() picks them up as they finish
+void HouseScene::requestScenePrograms(bool deferred) {
+	static const int sceneSurfaces[] = { SURFACE_LIT, SURFACE_TEXTURED, 0 };
+
+	for (int instanced = 0; instanced < 2; instanced++) {
+		for (int surface : sceneSurfaces) {
+			string vertexPath, fragmentPath;
+			ShaderVariants::Defines defines;
+			sceneProgramSource(deferred, instanced == 1, surface, &vertexPath, &fragmentPath, &defines);
+
+			GLuint program;
+			shaderVariants.request(vertexPath, fragmentPath, defines, &program);
+		}
 	}
 }
 
-void HouseScene::renderModel(Sphere* newModel, glm::mat4* transform, glm::mat4* T, GLuint* newTexture, int frontFace) {
-	if (newModel) {
-		// Calculate inverse transpose of the modelling transform for correct transformation of normal vectors
-		glm::mat4 inverseTranspose = glm::transpose(glm::inverse(*transform));
+HouseScene::SceneProgram* HouseScene::sceneProgram(bool instanced, int surface) {
+	SceneProgram *sceneProgram = &scenePrograms[renderDeferred ? 1 : 0][instanced ? 1 : 0][surface];
+
+	if (!sceneProgram->created) {
+		string vertexPath, fragmentPath;
+		ShaderVariants::Defines defines;
+		sceneProgramSource(renderDeferred, instanced, surface, &vertexPath, &fragmentPath, &defines);
+
+		// The full variant can stand in for any other, so it's the only one that's waited for. Until
+		// theirs is ready, untextured draws get a white texture and the sky picks up some highlights.
+		GLuint program;
+		if (surface == SURFACE_LIT)
+			program = shaderVariants.get(vertexPath, fragmentPath, defines);
+		else if (!shaderVariants.request(vertexPath, fragmentPath, defines, &program))
+			return HouseScene::sceneProgram(instanced, SURFACE_LIT);
+
+		sceneProgram->created = true;
+		sceneProgram->surface = surface;
+		sceneProgram->program = program;
+		if (!program)
+			return nullptr;
+
+		sceneProgram->modelMatrixLocation = glGetUniformLocation(program, "modelMatrix");
+		sceneProgram->invTransposeMatrixLocation = glGetUniformLocation(program, "invTransposeModelMatrix");
+		sceneProgram->viewProjectionLocation = glGetUniformLocation(program, "viewProjectionMatrix");
+		sceneProgram->cameraPosLocation = glGetUniformLocation(program, "cameraPos");
+
+		glUseProgram(program);
+		glUniform1i(glGetUniformLocation(program, "texture0"), 0);
+
+		// Forward variants read the same light buffer and clusters as the deferred lighting pass
+		if (!renderDeferred) {
+			GLuint lightBlockIndex = glGetUniformBlockIndex(program, "Lights");
+			if (lightBlockIndex != GL_INVALID_INDEX)
+				glUniformBlockBinding(program, lightBlockIndex, LIGHT_BLOCK_BINDING);
+			else
+				cout << "Phong shader has no Lights uniform block" << endl;
+
+			LightClusterer::setupProgram(program);
+		}
+
+		// The program was changed behind the queue's back
+		renderQueue.getStateCache()->invalidate();
+	}
+
+	if (!sceneProgram->program)
+		return nullptr;
 
-		glUseProgram(phongShader);
+	// Camera uniforms are the same for every draw so they're set once per render
+	if (sceneProgram->cameraRender != renderCount) {
+		sceneProgram->cameraRender = renderCount;
+		renderQueue.getStateCache()->useProgram(sceneProgram->program);
 
-		// Get the location of the camera in world coords and set the corresponding uniform in the shader
 		glm::vec3 cameraPos = earthCamera->getCameraPosition();
-		glUniform3fv(cameraPosLocation, 1, (GLfloat*)&cameraPos);
+		glUniform3fv(sceneProgram->cameraPosLocation, 1, (GLfloat*)&cameraPos);
+		glUniformMatrix4fv(sceneProgram->viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(renderViewProjection));
+	}
+
+	return sceneProgram;
+}
 
-		// Set the model, view and projection matrix uniforms (from the camera data obtained above)
-		glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(*transform));
-		glUniformMatrix4fv(invTransposeMatrixLocation, 1, GL_FALSE, glm::value_ptr(inverseTranspose));
-		glUniformMatrix4fv(viewProjectionMatrixLocation, 1, GL_FALSE, glm::value_ptr(*T));
+GLuint HouseScene::drawTexture(SceneProgram *program, int surface, GLuint *texture) {
+	if (!(surface & SURFACE_TEXTURED) && (program->surface & SURFACE_TEXTURED))
+		return whiteTexture;
 
-		// Activate and Bind the textures to texture units
-		if (newTexture) {
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, *newTexture);
-		}
+	return texture ? *texture : 0;
+}
 
-		//Render the model
-		glFrontFace(frontFace);
-		newModel->render();
-		glFrontFace(frontFace);
+void HouseScene::queueModel(const Frustum& frustum, InstancedMesh* newModel, GLuint* newTexture, int frontFace, int surface) {
+	if (!newModel->isLoaded())
+		return;
 
-		// Restore default OpenGL shaders (Fixed function operations)
-		glUseProgram(0);
-	}
+	int occluded = 0;
+	int visible = newModel->cull(frustum, useSoftwareOcclusion ? softwareOcclusion : nullptr, &occluded);
+	drawnCount += visible;
+	occludedCount += occluded;
+	culledCount += newModel->getTotalInstanceCount() - visible - occluded;
+
+	if (visible == 0)
+		return;
+
+	SceneProgram *program = sceneProgram(true, surface);
+	if (!program)
+		return;
+
+	RenderQueue::DrawItem item;
+	item.program = program->program;
+	item.texture = drawTexture(program, surface, newTexture);
+	item.frontFace = frontFace;
+	item.instancedMesh = newModel;
+
+	renderQueue.submit(item);
 }
 
-void HouseScene::renderLightSpheres() {
-	glm::mat4 T = earthCamera->getProjectionMatrix() * earthCamera->getViewMatrix();
-	glm::mat4 modelTransform;
+void HouseScene::queueModel(const Frustum& frustum, Model* newModel, int transformID, GLuint* newTexture, int frontFace, int surface) {
+	RenderQueue::DrawItem item;
+	item.model = newModel;
+	queueDraw(frustum, item, transformID, newTexture, frontFace, surface);
+}
+
+void HouseScene::queueModel(const Frustum& frustum, Sphere* newModel, int transformID, GLuint* newTexture, int frontFace, int surface) {
+	RenderQueue::DrawItem item;
+	item.sphere = newModel;
+	queueDraw(frustum, item, transformID, newTexture, frontFace, surface);
+}
 
-	for (int i = 0; i < dirLightParams.size(); i++) {
-		modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(dirLightParams[i].direction.x, dirLightParams[i].direction.y, dirLightParams[i].direction.z));
-		renderModel(lightSphereModel, &modelTransform, &T);
+void HouseScene::queueDraw(const Frustum& frustum, RenderQueue::DrawItem& item, int transformID, GLuint* newTexture, int frontFace, int surface) {
+	if (!item.model && !item.sphere)
+		return;
+
+	int occlusionID = transformID < (int)occlusionIDs.size() ? occlusionIDs[transformID] : -1;
+
+	const BoundingBox &bounds = transforms.getWorldBounds(transformID);
+	if (!frustum.intersects(bounds)) {
+		if (occlusionID >= 0)
+			occlusionCuller->reset(occlusionID);
+
+		culledCount++;
+		return;
+	}
+
+	if (useSoftwareOcclusion && !softwareOcclusion->isVisible(bounds)) {
+		if (occlusionID >= 0)
+			occlusionCuller->reset(occlusionID);
+
+		occludedCount++;
+		return;
 	}
 
-	for (int i = 0; i < pointLightParams.size(); i++) {
-		modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(pointLightParams[i].position.x, pointLightParams[i].position.y, pointLightParams[i].position.z));
-		renderModel(lightSphereModel, &modelTransform, &T);
+	glm::vec3 cameraPos = earthCamera->getCameraPosition();
+
+	if (useOcclusion && occlusionID >= 0 && !occlusionCuller->isVisible(occlusionID, bounds, cameraPos, &item.conditionQuery)) {
+		occludedCount++;
+		return;
 	}
+
+	SceneProgram *program = sceneProgram(false, surface);
+	if (!program)
+		return;
+
+	drawnCount++;
+
+	item.program = program->program;
+	item.texture = drawTexture(program, surface, newTexture);
+	item.frontFace = frontFace;
+	item.modelMatrix = &transforms.getModelMatrix(transformID);
+	item.invTransposeMatrix = &transforms.getInvTransposeMatrix(transformID);
+	item.modelMatrixLocation = program->modelMatrixLocation;
+	item.invTransposeMatrixLocation = program->invTransposeMatrixLocation;
+
+	// Distance from the camera to the model's origin is close enough for ordering
+	glm::vec3 origin = glm::vec3((*item.modelMatrix)[3]);
+	item.depth = glm::length(origin - cameraPos);
+
+	renderQueue.submit(item);
 }
 
 // Rendering methods
+void HouseScene::beginFrame() {
+	drawnCount = 0;
+	culledCount = 0;
+	occludedCount = 0;
+
+	// Variants that have finished building take over from the fallback in this frame. Once per frame
+	// rather than per render, so the fallback queue doesn't build a program for each tile or pass.
+	shaderVariants.update();
+}
+
 void HouseScene::render() {
 
+	render(glm::mat4(1.0), screenWidth, screenHeight);
+}
+
+// Renders the part of the image selected by projectionOffset (applied after the camera's projection)
+// into the bottom left viewportWidth x viewportHeight pixels of the FBO
+void HouseScene::render(const glm::mat4 &projectionOffset, int viewportWidth, int viewportHeight) {
+
 	if (!fboOkay)
 		return; // Don't render anything if the FBO was not created successfully
 
 	// Bind framebuffer object so all rendering redirected to attached images (i.e. our texture)
-	glBindFramebuffer(GL_FRAMEBUFFER, demoFBO);
+	// In MSAA mode render into the multisampled FBO, it's resolved into the texture at the end.
+	// Deferred renders into the G-buffer, it's lit into the texture at the end.
+	bool deferred = isDeferred();
+	glBindFramebuffer(GL_FRAMEBUFFER, msaaSamples > 1 ? msaaFBO : (deferred ? gBufferFBO : demoFBO));
+
+	// Shade every sample instead of once per pixel, so MSAA does the same shading work as SSAA
+	bool perSample = msaaSamples > 1 && sampleShading && GLExtensions::minSampleShading;
+	if (perSample) {
+		glEnable(GL_SAMPLE_SHADING);
+		GLExtensions::minSampleShading(1.0f);
+	}
 
 	// All rendering from this point goes to the bound textures (setup at initialisation time) and NOT the actual screen!!!!!
 
+	// Set viewport to specified texture size (see above)
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
 	// Clear the screen (i.e. the texture)
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	clearViewport(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, viewportWidth, viewportHeight);
 
-	// Set viewport to specified texture size (see above)
-	glViewport(0, 0, screenWidth, screenHeight);
+	if (lightsDirty)
+		uploadLights();
+	glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, lightUBO);
 
 	// Get view-projection transform as a CGMatrix4
-	glm::mat4 T = earthCamera->getProjectionMatrix() * earthCamera->getViewMatrix();
-	glm::mat4 modelTransform;
+	glm::mat4 T = projectionOffset * earthCamera->getProjectionMatrix() * earthCamera->getViewMatrix();
+
+	// Point lights are binned against the camera's whole view, the clusters stay the same for every
+	// tile or jittered render and the shader finds them through the offset
+	lightClusterer->update(earthCamera->getViewMatrix(), earthCamera->getProjectionMatrix(), projectionOffset, viewportWidth, viewportHeight);
+	lightClusterer->bind();
+
+	glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, pointLightTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	// Only does any work if something has moved
+	transforms.update();
+
+	// Culled against the matrix actually used, so each tile only draws what lands in it
+	Frustum frustum(T);
+
+	// Query results are only reused between renders of the whole view. A tile's projection offset
+	// scales the image, and one tile's results say nothing about the next. Jitter is only a shift.
+	useOcclusion = occlusionCulling && projectionOffset[0][0] == 1.0f && projectionOffset[1][1] == 1.0f;
+
+	// Rasterized with the matrix actually used, like the frustum
+	useSoftwareOcclusion = softwareOcclusionCulling;
+	if (useSoftwareOcclusion)
+		softwareOcclusion->render(T);
+
+	// The depth target has no alpha to blend with, and nothing is transparent anyway.
+	// lightGBuffer() turns it back on.
+	if (deferred)
+		glDisable(GL_BLEND);
+
+	// Programs picked while queueing get the camera uniforms for this render
+	renderCount++;
+	renderDeferred = deferred;
+	renderViewProjection = T;
+
+	// A backdrop, highlights on it would only look wrong
+	queueModel(frustum, skySphereModel, skyTransformID, &skySphereTexture, GL_CW, SURFACE_TEXTURED);
+	queueModel(frustum, houseModel, houseTransformID, &houseTexture);
+	queueModel(frustum, doorModel, doorTransformID, &doorTexture);
+	queueModel(frustum, landModel, landTransformID, &landTexture);
+	queueModel(frustum, ceilingLightModel, ceilingLightTransformID, &ceilingLightTexture);
+
+	if (fenceInstances->isLoaded()) {
+		queueModel(frustum, fenceInstances, &fenceTexture);
+	} else {
+		for (int i = 0; i < fenceRings * 15; i++)
+			queueModel(frustum, fenceModel, fenceTransformIDs[i], &fenceTexture);
+	}
 
-	modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(0.0f, 0.0f, 0.0f));
-	renderModel(skySphereModel, &modelTransform, &T, &skySphereTexture, GL_CW);
+	if (torchInstances->isLoaded()) {
+		queueModel(frustum, torchInstances, &torchTexture);
+	} else {
+		for (int torchTransformID : torchTransformIDs)
+			queueModel(frustum, torchModel, torchTransformID, &torchTexture);
+	}
 
-	modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(0.0f, 0.0f, 0.0f));
-	renderModel(houseModel, &modelTransform, &T, &houseTexture);
+	// Plain markers, the spheres used to pick up whichever texture was bound last
+	queueModel(frustum, lightSphereInstances, nullptr, GL_CCW, 0);
 
-	modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(1.65f, 0.0f, -1.9f));
-	modelTransform = glm::rotate(modelTransform, -50.0f * (3.1459f / 180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-	renderModel(doorModel, &modelTransform, &T, &doorTexture);
+	renderQueue.execute();
 
-	modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(0.0f, -0.5f, 0.0f));
-	renderModel(landModel, &modelTransform, &T, &landTexture);
+	// Binds demoFBO, whose depth is the G-buffer's, so the queries below work the same either way
+	if (deferred)
+		lightGBuffer(T, viewportWidth, viewportHeight);
 
-	modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(-4.6f, 0.3f, 0.0f));
-	renderModel(ceilingLightModel, &modelTransform, &T, &ceilingLightTexture);
+	// Tested against this render's depth, for the next render to use
+	if (useOcclusion)
+		occlusionCuller->issueQueries(T);
 
-	for (int i = 0; i < 15; i++) {
-		modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(0.0f, -0.5f, 0.0f));
-		modelTransform = glm::rotate(modelTransform, ((i * 17.0f) - 210.0f) * (3.1459f / 180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		renderModel(fenceModel, &modelTransform, &T, &fenceTexture);
-	}
-
-	for (int i = 0; i < 2; i++) {
-		modelTransform = glm::translate(glm::mat4(1.0), glm::vec3(0.0f, -0.5f, i * 4));
-		renderModel(torchModel, &modelTransform, &T, &torchTexture);
-	}
+	if (perSample)
+		glDisable(GL_SAMPLE_SHADING);
 
-	//will render a sphere on the origin point of each light
-	renderLightSpheres();
+	if (msaaSamples > 1)
+		resolveMSAA();
 
 	// Set OpenGL to render to the MAIN framebuffer (ie. the screen itself!!)
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -3,6 +3,31 @@
 
 #include "Camera.h"
 #include "Includes.h"
+#include "LightClusterer.h"
+#include "RenderQueue.h"
+#include "ShaderVariants.h"
+#include "TransformStore.h"
+#include "OcclusionCuller.h"
+#include "SoftwareOcclusion.h"
+
+// How the multisampled render target is resolved into the scene texture
+enum MSAAResolveMode { MSAA_RESOLVE_BLIT, MSAA_RESOLVE_SHADER };
+
+// Forward lights every fragment as it's drawn. Deferred draws albedo, normal and depth into a
+// G-buffer and then lights each pixel (each supersample under SSAA) once in a fullscreen pass, so
+// fragments that get drawn over are never lit. MSAA always renders forward.
+enum ShadingPath { SHADING_FORWARD, SHADING_DEFERRED };
+
+// "forward" or "deferred", returns false for anything else
+bool parseShadingPath(const std::string &name, ShadingPath *path);
+const char *shadingPathName(ShadingPath path);
+
+// Size of the light array in the Lights uniform block, compiled into the lighting shaders as a define.
+// Point lights are clustered and can be any number.
+const int NUM_OF_DIR_LIGHTS = 1;
+
+// Uniform buffer binding point of the Lights block, any program declaring the block can share it
+const GLuint LIGHT_BLOCK_BINDING = 0;
 
 class HouseScene {
 	private:
@@ -10,48 +35,40 @@ class HouseScene {
 		int screenWidth = 800;
 		int screenHeight = 800;
 
-		enum LightType {DIRECTION, POINT};
+		//the supersampling factor the fbo was created with
+		int samples = 1;
+
+		//when non zero the fbo is only one tile of this size and the image is rendered a tile at a time
+		int tileSize = 0;
 
+		// The light structs mirror the std140 layout of the light structs in Phong_shader.frag (every
+		// field starts on a 16 byte boundary and each struct is padded to a multiple of 16). Point
+		// lights are read as 5 RGBA32F texels each from a buffer texture with the same layout.
 		struct DirecionalLightParams {
 			glm::vec4 direction;
 			glm::vec4 diffuse;
 			glm::vec4 specular;
 			glm::vec4 ambient;
 			float exponent;
+			float padding[3];
 		};
 		vector<DirecionalLightParams> dirLightParams;
 
-		struct DirectionalLightUniforms {
-			GLint directionLocation;
-			GLint diffuseLocation;
-			GLint specularLocation;
-			GLint ambientLocation;
-			GLint specExpLocation;
-		};
-		vector<DirectionalLightUniforms> dirLightUniforms;
-
 		struct PointLightParams {
 			glm::vec4 position;
 			glm::vec4 diffuse;
 			glm::vec4 specular;
 			glm::vec4 ambient;
-			float exponent;
 			glm::vec3 attenuation;
+			float exponent;
 		};
 		vector<PointLightParams> pointLightParams;
 
-		struct PointLightUniforms {
-			GLint directionLocation;
-			GLint diffuseLocation;
-			GLint specularLocation;
-			GLint ambientLocation;
-			GLint specExpLocation;
-			GLint attenuation;
-		};
-		vector<PointLightUniforms> pointLightUniforms;
+		// Lights after the scene's own are the extra torches added for stress testing
+		int								sceneLightCount;
+		int								extraLights = 0;
 
 		Sphere							*skySphereModel;
-		Sphere							*lightSphereModel;
 
 		Model							*houseModel;
 		Model							*landModel;
@@ -60,6 +77,45 @@ class HouseScene {
 		Model							*ceilingLightModel;
 		Model							*fenceModel;
 
+		// Repeated models are drawn with one instanced call each. The fence and torches fall back
+		// to a draw per copy if their model couldn't be loaded for instancing.
+		InstancedMesh					*fenceInstances;
+		InstancedMesh					*torchInstances;
+		InstancedMesh					*lightSphereInstances;
+
+		// Copies of the fence ring, each one further out (more than 1 is only for stress testing)
+		int								fenceRings = 1;
+
+		// Model matrices are worked out once when the scene is created, only moved objects are recomputed
+		TransformStore					transforms;
+		int								skyTransformID;
+		int								houseTransformID;
+		int								doorTransformID;
+		int								landTransformID;
+		int								ceilingLightTransformID;
+
+		// Objects (counting each instance) drawn, frustum culled and occlusion culled this frame, summed
+		// over every render of it (tiles, jittered samples)
+		int								drawnCount = 0;
+		int								culledCount = 0;
+		int								occludedCount = 0;
+
+		// Occlusion queries for the single models (not the sky, which is always visible from inside,
+		// or instanced models). Each transform ID maps to an occluder ID, -1 for none.
+		OcclusionCuller					*occlusionCuller;
+		bool							occlusionCulling = true;
+		vector<int>						occlusionIDs;
+
+		// CPU occlusion culling with the house and land as occluders, tested before the queries so
+		// they only see what it couldn't rule out. It's redone every render, so tiles can use it too.
+		SoftwareOcclusion				*softwareOcclusion;
+		bool							softwareOcclusionCulling = true;
+
+		// Only drawn through these when instancing isn't available, the store may hold more
+		// fence transforms than fenceRings needs after the rings are reduced
+		vector<int>						fenceTransformIDs;
+		vector<int>						torchTransformIDs;
+
 		// Move around the earth with a seperate camera to the main scene camera
 		Camera							*earthCamera;
 
@@ -73,27 +129,62 @@ class HouseScene {
 		GLuint							ceilingLightTexture;
 		GLuint							fenceTexture;
 
-		// Shader for multi-texturing the earth
-		GLuint							phongShader;
-
-
-		// Unifom locations for earthShader
-
-		// Texture uniforms
-		GLuint							modelTextureUniform;
-
-		// Camera uniforms
-		GLint							modelMatrixLocation;
-		GLint							invTransposeMatrixLocation;
-		GLint							viewProjectionMatrixLocation;
+		// Phong (or G-buffer) programs are compiled per surface type, so each draw only pays for what
+		// it uses: the sky has no highlights and the light spheres have neither texture nor highlights
+		enum SurfaceFlags { SURFACE_TEXTURED = 1, SURFACE_SPECULAR = 2, SURFACE_LIT = SURFACE_TEXTURED | SURFACE_SPECULAR };
+
+		// A variant along with the uniforms render() sets on it
+		struct SceneProgram {
+			bool						created = false;
+			GLuint						program = 0;
+			int							surface;
+			GLint						modelMatrixLocation;
+			GLint						invTransposeMatrixLocation;
+			GLint						viewProjectionLocation;
+			GLint						cameraPosLocation;
+
+			// The render the camera uniforms were last set for
+			int							cameraRender = -1;
+		};
 
-		// Directional light uniforms
-		/*vector<GLint>					lightDirectionLocation;
-		vector<GLint>					lightDiffuseLocation;
-		vector<GLint>					lightSpecularLocation;
-		vector<GLint>					lightSpecExpLocation;
-		vector<GLint>					lightAttenuation;*/
-		GLint							cameraPosLocation;
+		ShaderVariants					shaderVariants;
+
+		// [deferred][instanced][surface flags]. The active shading path's are requested when the scene is
+		// created and the other path's when setShadingPath() switches to it. They're built in the
+		// background, draws use the SURFACE_LIT variant until theirs is ready.
+		SceneProgram					scenePrograms[2][2][4];
+
+		// Bound for untextured draws that fall back on a textured variant, so they come out the same
+		GLuint							whiteTexture;
+
+		// Counts renders so programs only get the camera uniforms once each
+		int								renderCount = 0;
+		bool							renderDeferred = false;
+		glm::mat4						renderViewProjection;
+
+		// The program for this render's path, with the camera uniforms set. Null if it didn't compile.
+		SceneProgram*					sceneProgram(bool instanced, int surface);
+		void							sceneProgramSource(bool deferred, bool instanced, int surface, std::string *vertexPath, std::string *fragmentPath, ShaderVariants::Defines *defines);
+		void							requestScenePrograms(bool deferred);
+		GLuint							drawTexture(SceneProgram *program, int surface, GLuint *texture);
+
+		// Fullscreen pass lighting the G-buffer
+		GLuint							deferredLightingShader;
+		GLint							deferredCameraPosLocation;
+		GLint							inverseViewProjectionLocation;
+		GLint							viewportSizeLocation;
+
+		// The directional lights are in one uniform buffer and the point lights in a buffer texture,
+		// each re-uploaded in a single call when a light has changed
+		GLuint							lightUBO;
+		GLuint							pointLightBuffer;
+		GLuint							pointLightTexture;
+		bool							lightsDirty = true;
+
+		// Bins the point lights into clusters every render so each fragment only evaluates the
+		// ones that reach it. Off puts them all in one cluster.
+		LightClusterer					*lightClusterer;
+		bool							lightClustering = true;
 
 		//
 		// Animation state
@@ -117,24 +208,132 @@ class HouseScene {
 		// Flag to indicate that the FBO is valid
 		bool							fboOkay;
 
-		void							setupLight(DirecionalLightParams*);
-		void							setupLight(PointLightParams*);
+		//
+		// Multisampled render target (MSAA mode), resolved into fboColourTexture after rendering
+		//
+		int								msaaSamples = 1;
+		bool							sampleShading = false;
+		MSAAResolveMode					msaaResolveMode = MSAA_RESOLVE_BLIT;
+
+		GLuint							msaaFBO = 0;
+		GLuint							msaaColourTexture = 0;
+		GLuint							msaaDepthRenderbuffer = 0;
+
+		GLuint							msaaResolveShader;
+		GLint							msaaSamplesLocation;
+		GLuint							emptyVAO;
 
-		void							updateLight(LightType, int);
+		//
+		// G-buffer (deferred shading without MSAA). It shares fboDepthTexture with demoFBO, so the
+		// depth (and the stencil adaptive supersampling writes) is the same whichever path drew it.
+		//
+		ShadingPath						shadingPath = SHADING_FORWARD;
 
-		void							renderLightSpheres();
+		GLuint							gBufferFBO = 0;
+		GLuint							gBufferAlbedoTexture = 0;
+		GLuint							gBufferNormalTexture = 0;
+		GLuint							gBufferDepthTexture = 0;
 
-		void							renderModel(Model*, glm::mat4*, glm::mat4*, GLuint* = nullptr, int frontFace = GL_CCW);
-		void							renderModel(Sphere*, glm::mat4*, glm::mat4*, GLuint* = nullptr, int frontFace = GL_CCW);
+		void							setupFBO();
+		void							setupMSAAFBO();
+		void							setupGBuffer();
+		void							deleteFBO();
+		void							resolveMSAA();
+
+		// Lights the G-buffer into demoFBO, viewProjection is the matrix it was drawn with
+		void							lightGBuffer(const glm::mat4 &viewProjection, int viewportWidth, int viewportHeight);
+
+		// Clears only the viewport, the targets are allocated for the largest dynamic resolution scale
+		void							clearViewport(GLbitfield buffers, int viewportWidth, int viewportHeight);
+
+		void							uploadLights();
+
+		// Distance past which a point light adds less than 1/256 to any colour channel
+		static float					lightRadius(const PointLightParams &light);
+
+		vector<glm::mat4>				fenceTransforms();
+		vector<glm::mat4>				torchTransforms();
+		void							setupTransforms();
+		void							updateFenceTransforms();
+
+		// Draws are queued during render() and submitted sorted by state once everything is in
+		RenderQueue						renderQueue;
+
+		// Anything outside the frustum is counted as culled and not queued. surface is a combination of
+		// SurfaceFlags picking the program variant.
+		void							queueModel(const Frustum&, InstancedMesh*, GLuint*, int frontFace = GL_CCW, int surface = SURFACE_LIT);
+		void							queueModel(const Frustum&, Model*, int transformID, GLuint*, int frontFace = GL_CCW, int surface = SURFACE_LIT);
+		void							queueModel(const Frustum&, Sphere*, int transformID, GLuint*, int frontFace = GL_CCW, int surface = SURFACE_LIT);
+		void							queueDraw(const Frustum&, RenderQueue::DrawItem&, int transformID, GLuint*, int frontFace, int surface);
+
+		// Only when the results can carry over from the last render, see render()
+		bool							useOcclusion = false;
+		bool							useSoftwareOcclusion = false;
 	public:
 
 		HouseScene(int newWidth = 800, int newHeight = 800, int sampleSize = 1);
 		~HouseScene();
 
 		// Accessor methods
-		void updateScene(int newWidth = 800, int newHeight = 800, int sampleSize = 1);
+		// Sets the output size, SSAA factor and MSAA sample count (1 turns MSAA off) together, so the
+		// render targets are only reallocated once however many of them change
+		void updateScene(int newWidth = 800, int newHeight = 800, int sampleSize = 1, int newMSAASamples = 1);
+		int getSampleSize();
+
+		// Number of fence rings to draw (1 is the normal scene), for stressing the instanced path
+		void setFenceRings(int rings);
+
+		// Adds count torch lights spread around the village on top of the scene's own, for stressing
+		// the clustered lighting
+		void setExtraLights(int count);
+		int getPointLightCount();
+
+		void setLightClustering(bool enabled);
+		bool getLightClustering();
+
+		// CPU time spent binning lights in the last render, and the average lights per cluster
+		float getLightBinMs();
+		float getLightsPerCluster();
+
+		// Only allocate a tileSize x tileSize target (0 for the whole image), takes effect on the next updateScene
+		void setTileSize(int newTileSize);
+
+		// How MSAA renders, the sample count is given to updateScene. perSampleShading runs the fragment
+		// shader for every sample, like SSAA does.
+		void setMSAAOptions(bool perSampleShading, MSAAResolveMode resolveMode);
+		int getMSAASamples();
+
+		// Reallocates the render targets if the path changes, deferred only takes effect without MSAA
+		void setShadingPath(ShadingPath path);
+		ShadingPath getShadingPath();
+
+		// Whether render() actually shades deferred, which needs the path set and MSAA off
+		bool isDeferred();
 		Camera* getHouseSceneCamera();
 		GLuint getHouseSceneTexture();
+		GLuint getHouseSceneDepthTexture();
+		GLuint getHouseSceneFramebuffer();
+
+		// Programs compiled so far, each combination of shaders and defines counts once
+		int getShaderVariantCount();
+
+		// Variants still being built, until then their draws use the full Phong (or G-buffer) program
+		int getPendingShaderCount();
+
+		// Waits for them, so every render from now on uses the intended programs. Only the variants of
+		// the shading paths used so far have been requested, so call it again after setShadingPath().
+		void finishShaders();
+		// Off draws everything that passes the frustum test
+		void setOcclusionCulling(bool enabled);
+		bool getOcclusionCulling();
+
+		// Off skips the CPU depth buffer, the occlusion queries still run if they're on
+		void setSoftwareOcclusion(bool enabled);
+		bool getSoftwareOcclusion();
+
+		int getDrawnCount();
+		int getCulledCount();
+		int getOccludedCount();
 		float getSunTheta();
 		void updateSunTheta(float thetaDelta);
 
@@ -142,6 +341,11 @@ class HouseScene {
 		void update(const float timeDelta);
 
 		// Rendering methods
+		// Call once per frame before its renders, a frame can render the scene several times. Also
+		// picks up shader variants that have finished building.
+		void beginFrame();
+
 		void render();
+		void render(const glm::mat4 &projectionOffset, int viewportWidth, int viewportHeight);
 };
 #endif
\ No newline at end of file
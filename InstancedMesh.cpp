@@ -0,0 +1,255 @@
+#include "InstancedMesh.h"
+#include <algorithm>
+#include <cfloat>
+
+using namespace std;
+
+static const int FLOATS_PER_VERTEX = 8;
+
+// First attribute location of the two per-instance mat4s (4 locations each)
+static const GLuint MODEL_MATRIX_LOCATION = 6;
+static const GLuint NORMAL_MATRIX_LOCATION = 10;
+
+static const float PI = 3.14159265f;
+
+InstancedMesh::InstancedMesh(const string &path) {
+	Assimp::Importer importer;
+
+	// Same orientation as the Model class so the scene's textures line up
+	const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs);
+
+	if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
+		cout << "Couldn't load " << path << " for instancing: " << importer.GetErrorString() << endl;
+		return;
+	}
+
+	vector<float> vertices;
+	vector<GLuint> indices;
+
+	localBounds.min = glm::vec3(FLT_MAX);
+	localBounds.max = glm::vec3(-FLT_MAX);
+
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+		const aiMesh *mesh = scene->mMeshes[m];
+		GLuint firstVertex = (GLuint)(vertices.size() / FLOATS_PER_VERTEX);
+
+		for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+			const aiVector3D &position = mesh->mVertices[v];
+			localBounds.min = glm::vec3(min(localBounds.min.x, position.x), min(localBounds.min.y, position.y), min(localBounds.min.z, position.z));
+			localBounds.max = glm::vec3(max(localBounds.max.x, position.x), max(localBounds.max.y, position.y), max(localBounds.max.z, position.z));
+
+			vertices.push_back(position.x);
+			vertices.push_back(position.y);
+			vertices.push_back(position.z);
+
+			if (mesh->HasNormals()) {
+				vertices.push_back(mesh->mNormals[v].x);
+				vertices.push_back(mesh->mNormals[v].y);
+				vertices.push_back(mesh->mNormals[v].z);
+			} else {
+				vertices.insert(vertices.end(), { 0.0f, 1.0f, 0.0f });
+			}
+
+			if (mesh->HasTextureCoords(0)) {
+				vertices.push_back(mesh->mTextureCoords[0][v].x);
+				vertices.push_back(mesh->mTextureCoords[0][v].y);
+			} else {
+				vertices.insert(vertices.end(), { 0.0f, 0.0f });
+			}
+		}
+
+		for (unsigned int f = 0; f < mesh->mNumFaces; f++) {
+			const aiFace &face = mesh->mFaces[f];
+
+			// Points and lines survive triangulation, they're skipped
+			if (face.mNumIndices != 3)
+				continue;
+
+			for (unsigned int i = 0; i < 3; i++)
+				indices.push_back(firstVertex + face.mIndices[i]);
+		}
+	}
+
+	createBuffers(vertices, indices);
+}
+
+InstancedMesh::InstancedMesh(float radius, int slices, int stacks) {
+	vector<float> vertices;
+	vector<GLuint> indices;
+
+	localBounds.min = glm::vec3(-radius);
+	localBounds.max = glm::vec3(radius);
+
+	for (int stack = 0; stack <= stacks; stack++) {
+		float phi = PI * stack / stacks;
+
+		for (int slice = 0; slice <= slices; slice++) {
+			float theta = 2.0f * PI * slice / slices;
+
+			glm::vec3 normal(sin(phi) * cos(theta), cos(phi), sin(phi) * sin(theta));
+
+			vertices.insert(vertices.end(), { normal.x * radius, normal.y * radius, normal.z * radius, normal.x, normal.y, normal.z,
+				(float)slice / slices, 1.0f - (float)stack / stacks });
+		}
+	}
+
+	// Counter-clockwise seen from outside
+	for (int stack = 0; stack < stacks; stack++) {
+		for (int slice = 0; slice < slices; slice++) {
+			GLuint a = stack * (slices + 1) + slice;
+			GLuint b = a + slices + 1;
+
+			indices.insert(indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+		}
+	}
+
+	createBuffers(vertices, indices);
+}
+
+InstancedMesh::~InstancedMesh() {
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+	glDeleteBuffers(1, &instanceBuffer);
+}
+
+void InstancedMesh::createBuffers(const vector<float> &vertices, const vector<GLuint> &indices) {
+	if (indices.empty())
+		return;
+
+	indexCount = (int)indices.size();
+
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	glGenBuffers(1, &vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+	GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+	// Each instance is its model matrix followed by the inverse transpose, a mat4 takes 4 attribute locations
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	GLsizei instanceStride = 2 * sizeof(glm::mat4);
+	for (GLuint column = 0; column < 4; column++) {
+		glEnableVertexAttribArray(MODEL_MATRIX_LOCATION + column);
+		glVertexAttribPointer(MODEL_MATRIX_LOCATION + column, 4, GL_FLOAT, GL_FALSE, instanceStride, (void*)(column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(MODEL_MATRIX_LOCATION + column, 1);
+
+		glEnableVertexAttribArray(NORMAL_MATRIX_LOCATION + column);
+		glVertexAttribPointer(NORMAL_MATRIX_LOCATION + column, 4, GL_FLOAT, GL_FALSE, instanceStride, (void*)(sizeof(glm::mat4) + column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(NORMAL_MATRIX_LOCATION + column, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool InstancedMesh::isLoaded() {
+
+	return vao != 0;
+}
+
+void InstancedMesh::setInstances(const vector<glm::mat4> &modelMatrices) {
+	if (!isLoaded())
+		return;
+
+	allInstances.clear();
+	instanceBounds.clear();
+	allInstances.reserve(modelMatrices.size() * 2);
+
+	for (const glm::mat4 &modelMatrix : modelMatrices) {
+		allInstances.push_back(modelMatrix);
+		allInstances.push_back(glm::transpose(glm::inverse(modelMatrix)));
+		instanceBounds.push_back(localBounds.transformed(modelMatrix));
+	}
+
+	vector<int> everyInstance(modelMatrices.size());
+	for (size_t i = 0; i < everyInstance.size(); i++)
+		everyInstance[i] = (int)i;
+
+	uploadInstances(everyInstance);
+}
+
+void InstancedMesh::uploadInstances(const vector<int> &instances) {
+	visibleInstances = instances;
+	instanceCount = (int)instances.size();
+
+	uploadData.clear();
+	for (int instance : instances) {
+		uploadData.push_back(allInstances[instance * 2]);
+		uploadData.push_back(allInstances[instance * 2 + 1]);
+	}
+
+	if (uploadData.empty())
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	if (instanceCount > instanceCapacity) {
+		instanceCapacity = instanceCount;
+		glBufferData(GL_ARRAY_BUFFER, uploadData.size() * sizeof(glm::mat4), uploadData.data(), GL_DYNAMIC_DRAW);
+	} else {
+		// Tiled SSAA culls, uploads and draws several times a frame. Writing into the storage the last
+		// tile's draw is still reading would wait for it, so orphan it and let the driver hand out fresh
+		// storage while the old one is still in use.
+		glBufferData(GL_ARRAY_BUFFER, instanceCapacity * 2 * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, uploadData.size() * sizeof(glm::mat4), uploadData.data());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+int InstancedMesh::cull(const Frustum &frustum, const SoftwareOcclusion *occlusion, int *occluded) {
+	newVisibleInstances.clear();
+
+	if (occluded)
+		*occluded = 0;
+
+	for (size_t i = 0; i < instanceBounds.size(); i++) {
+		if (!frustum.intersects(instanceBounds[i]))
+			continue;
+
+		if (occlusion && !occlusion->isVisible(instanceBounds[i])) {
+			if (occluded)
+				(*occluded)++;
+			continue;
+		}
+
+		newVisibleInstances.push_back((int)i);
+	}
+
+	if (newVisibleInstances != visibleInstances)
+		uploadInstances(newVisibleInstances);
+
+	return instanceCount;
+}
+
+int InstancedMesh::getInstanceCount() {
+
+	return instanceCount;
+}
+
+int InstancedMesh::getTotalInstanceCount() {
+
+	return (int)instanceBounds.size();
+}
+
+void InstancedMesh::render() {
+	if (!isLoaded() || instanceCount == 0)
+		return;
+
+	glBindVertexArray(vao);
+	glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, instanceCount);
+	glBindVertexArray(0);
+}
@@ -0,0 +1,69 @@
+#ifndef INSTANCEDMESH_H
+#define INSTANCEDMESH_H
+
+#include "Includes.h"
+#include "Frustum.h"
+#include "SoftwareOcclusion.h"
+#include <vector>
+
+// A mesh drawn many times with one glDrawElementsInstanced call. Each instance's model matrix and
+// its inverse transpose (for the normals) come from an instance VBO with an attribute divisor of 1,
+// so nothing is uploaded or inverted per draw. Vertices use the same attribute locations as the
+// Phong shader (position 0, normal 1, texture coordinate 2) and the instance matrices use 6-13,
+// see PhongInstanced_shader.vert.
+class InstancedMesh {
+	private:
+		GLuint							vao = 0;
+		GLuint							vertexBuffer = 0;
+		GLuint							indexBuffer = 0;
+		GLuint							instanceBuffer = 0;
+
+		int								indexCount = 0;
+
+		// Instances in the buffer, only the ones that passed the last cull()
+		int								instanceCount = 0;
+
+		BoundingBox						localBounds;
+
+		// Every instance's model matrix then inverse transpose, and its world bounds
+		std::vector<glm::mat4>			allInstances;
+		std::vector<BoundingBox>		instanceBounds;
+
+		// Indices of the instances currently in the buffer
+		std::vector<int>				visibleInstances;
+		std::vector<int>				newVisibleInstances;
+		std::vector<glm::mat4>			uploadData;
+
+		void							uploadInstances(const std::vector<int> &instances);
+
+		// Instances the buffer has room for, it only grows
+		int								instanceCapacity = 0;
+
+		// Interleaved position (3), normal (3) and texture coordinate (2)
+		void							createBuffers(const std::vector<float> &vertices, const std::vector<GLuint> &indices);
+
+	public:
+		// Loads every mesh in the file into one vertex buffer. Materials are ignored, the caller binds the texture.
+		InstancedMesh(const std::string &path);
+
+		// UV sphere centred on the origin
+		InstancedMesh(float radius, int slices, int stacks);
+
+		~InstancedMesh();
+
+		bool isLoaded();
+
+		// Replaces all the instances, they're all drawn until the next cull()
+		void setInstances(const std::vector<glm::mat4> &modelMatrices);
+		int getInstanceCount();
+
+		// Only draws the instances whose bounds intersect the frustum, returns how many that is.
+		// With occlusion, instances it says are hidden are dropped too and counted in *occluded.
+		// The instance buffer is only rewritten when the visible set changes.
+		int cull(const Frustum &frustum, const SoftwareOcclusion *occlusion = nullptr, int *occluded = nullptr);
+		int getTotalInstanceCount();
+
+		// Draws every instance, the program and texture must already be bound
+		void render();
+};
+#endif
@@ -0,0 +1,190 @@
+#include "LightBenchmark.h"
+#include "FrameStats.h"
+#include "HouseScene.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const int WARMUP_RENDERS = 3;
+static const int TIMED_RENDERS = 10;
+
+static const int LIGHT_COUNTS[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+
+// SSAA factors, the scene is rendered at width * factor x height * factor
+static const int FACTORS[] = { 1, 2, 4, 8 };
+
+// MSAA sample counts, rendered at width x height
+static const int MSAA_SAMPLES[] = { 4, 8 };
+
+// One timed configuration, kept for the --bench-csv and --bench-json output
+struct LightRun {
+	string			aa;
+	int				factor;
+	string			shading;
+	bool			clustered;
+	int				lights;
+	FrameStats		stats;
+};
+
+// Times TIMED_RENDERS renders one by one, waiting for the GPU after each so they cover the binning and the drawing
+static LightRun timeRender(HouseScene *scene, const char *aa, int factor, float bucketMs) {
+	LightRun run = { aa, factor, scene->isDeferred() ? "deferred" : "forward", scene->getLightClustering(),
+		scene->getPointLightCount(), FrameStats(0.0f, TIMED_RENDERS, bucketMs) };
+
+	for (int i = 0; i < WARMUP_RENDERS; i++)
+		scene->render();
+	glFinish();
+
+	for (int i = 0; i < TIMED_RENDERS; i++) {
+		auto start = chrono::high_resolution_clock::now();
+		scene->render();
+		glFinish();
+		run.stats.addFrame(chrono::duration<float>(chrono::high_resolution_clock::now() - start).count());
+	}
+
+	return run;
+}
+
+static string runName(const LightRun &run) {
+	char name[96];
+	snprintf(name, sizeof(name), "%s x%d %s%s, %d lights", run.aa.c_str(), run.factor, run.shading.c_str(),
+		run.clustered ? "" : " unclustered", run.lights);
+	return name;
+}
+
+// Same columns as FrameStats::writeCSV with the configuration in front of them
+static bool writeCSV(vector<LightRun> &runs, const AppSettings &settings) {
+	ofstream file(settings.benchCSV);
+	if (!file) {
+		cout << "Could not open " << settings.benchCSV << " for writing" << endl;
+		return false;
+	}
+
+	file << "label,aa,factor,shading,clustered,lights,frame,frame_ms" << endl;
+	for (LightRun &run : runs) {
+		string prefix = settings.benchLabel + "," + run.aa + "," + to_string(run.factor) + "," + run.shading + ","
+			+ (run.clustered ? "1" : "0") + "," + to_string(run.lights) + ",";
+		run.stats.writeCSVRows(file, prefix);
+	}
+
+	return true;
+}
+
+// An array of FrameStats::writeJSON's summaries, one per configuration
+static bool writeJSON(vector<LightRun> &runs, const AppSettings &settings) {
+	ofstream file(settings.benchJSON);
+	if (!file) {
+		cout << "Could not open " << settings.benchJSON << " for writing" << endl;
+		return false;
+	}
+
+	file << "[" << endl;
+	for (size_t i = 0; i < runs.size(); i++) {
+		runs[i].stats.writeJSONObject(file, settings.benchLabel + ": " + runName(runs[i]), "  ");
+		file << (i + 1 < runs.size() ? "," : "") << endl;
+	}
+	file << "]" << endl;
+
+	return true;
+}
+
+bool runLightBenchmark(int width, int height, const AppSettings &settings) {
+	HouseScene scene(width, height, 1);
+
+	// Timing the fallback programs would make the first results look worse than they are
+	scene.finishShaders();
+
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+	vector<LightRun> runs;
+
+	printf("Light benchmark %s, ms per render: mean and p95 of %d renders\n", settings.benchLabel.c_str(), TIMED_RENDERS);
+
+	for (int factor : FACTORS) {
+		if (width * factor > maxTextureSize || height * factor > maxTextureSize) {
+			printf("SSAA x%d skipped, %dx%d is over the %d texture size limit\n", factor, width * factor, height * factor, maxTextureSize);
+			continue;
+		}
+
+		while (glGetError() != GL_NO_ERROR);
+		scene.updateScene(width, height, factor);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, scene.getHouseSceneFramebuffer());
+		bool complete = glGetError() == GL_NO_ERROR && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (!complete) {
+			printf("SSAA x%d skipped, couldn't allocate the %dx%d scene framebuffer\n", factor, width * factor, height * factor);
+			if (factor == 1)
+				return false;
+			continue;
+		}
+
+		printf("Lighting at %dx%d (SSAA x%d)\n", width * factor, height * factor, factor);
+		printf("%-7s %9s %9s %9s %9s %8s %15s %15s\n", "lights", "fwd ms", "fwd p95", "def ms", "def p95", "bin ms", "lights/cluster", "unclustered ms");
+
+		for (int extraLights : LIGHT_COUNTS) {
+			scene.setExtraLights(extraLights);
+			scene.setLightClustering(true);
+
+			// The deferred variants are only requested once the scene switches to that path
+			scene.setShadingPath(SHADING_DEFERRED);
+			scene.finishShaders();
+			runs.push_back(timeRender(&scene, "ssaa", factor, settings.benchBucketMs));
+			FrameStats &deferred = runs.back().stats;
+			float deferredMean = deferred.meanFrameTime(), deferredP95 = deferred.percentile(95.0f);
+
+			scene.setShadingPath(SHADING_FORWARD);
+			runs.push_back(timeRender(&scene, "ssaa", factor, settings.benchBucketMs));
+			FrameStats &forward = runs.back().stats;
+
+			printf("%-7d %9.3f %9.3f %9.3f %9.3f %8.3f %15.2f ", scene.getPointLightCount(), forward.meanFrameTime(),
+				forward.percentile(95.0f), deferredMean, deferredP95, scene.getLightBinMs(), scene.getLightsPerCluster());
+
+			// Every light on every supersample takes too long at the bigger factors to be worth waiting for
+			if (factor == 1) {
+				scene.setLightClustering(false);
+				runs.push_back(timeRender(&scene, "ssaa", factor, settings.benchBucketMs));
+				printf("%15.3f\n", runs.back().stats.meanFrameTime());
+			} else {
+				printf("%15s\n", "-");
+			}
+			fflush(stdout);
+		}
+	}
+
+	// The G-buffer isn't multisampled, so with MSAA the deferred path renders forward anyway
+	for (int msaaSamples : MSAA_SAMPLES) {
+		scene.updateScene(width, height, 1, msaaSamples);
+		if (scene.getMSAASamples() != msaaSamples) {
+			printf("MSAA x%d skipped, the driver allows at most x%d\n", msaaSamples, scene.getMSAASamples());
+			continue;
+		}
+
+		printf("Lighting at %dx%d (MSAA x%d), forward only\n", width, height, msaaSamples);
+		printf("%-7s %9s %9s %9s %9s %8s %15s\n", "lights", "fwd ms", "fwd p95", "def ms", "def p95", "bin ms", "lights/cluster");
+
+		scene.setShadingPath(SHADING_FORWARD);
+		scene.setLightClustering(true);
+
+		for (int extraLights : LIGHT_COUNTS) {
+			scene.setExtraLights(extraLights);
+			runs.push_back(timeRender(&scene, "msaa", msaaSamples, settings.benchBucketMs));
+			FrameStats &forward = runs.back().stats;
+
+			printf("%-7d %9.3f %9.3f %9s %9s %8.3f %15.2f\n", scene.getPointLightCount(), forward.meanFrameTime(),
+				forward.percentile(95.0f), "fwd only", "fwd only", scene.getLightBinMs(), scene.getLightsPerCluster());
+			fflush(stdout);
+		}
+	}
+
+	if (!settings.benchCSV.empty())
+		writeCSV(runs, settings);
+	if (!settings.benchJSON.empty())
+		writeJSON(runs, settings);
+
+	return true;
+}
@@ -0,0 +1,16 @@
+#ifndef LIGHTBENCHMARK_H
+#define LIGHTBENCHMARK_H
+
+#include "CommandLine.h"
+
+// Renders the house scene with 1 to 4096 extra torch lights at SSAA factors 1, 2, 4 and 8, shaded
+// forward and deferred (both clustered), then at MSAA x4 and x8 forward only, since the G-buffer
+// isn't multisampled. Prints the mean and p95 ms per render, the CPU time spent binning and the
+// average lights per cluster. At factor 1 forward is also timed with every light in one cluster
+// (every fragment loops over every light). Factors too big for the GPU are skipped. Every
+// configuration's render times go to settings' --bench-csv and --bench-json files, tagged with
+// --bench-label. Needs a current context.
+// Returns false if the scene couldn't be rendered.
+bool runLightBenchmark(int width, int height, const AppSettings &settings);
+
+#endif
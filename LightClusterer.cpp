@@ -0,0 +1,310 @@
+#include "LightClusterer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+
+LightClusterer::LightClusterer(int threads) {
+	workers = new WorkerPool(threads);
+	clusterLights.resize(clustersX * clustersY * clustersZ);
+
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxBufferTexels);
+
+	// The buffers are refilled every render, the textures stay pointed at them
+	glGenBuffers(1, &clusterBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, clusterBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * 2, NULL, GL_STREAM_DRAW);
+
+	glGenTextures(1, &clusterTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, clusterTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, clusterBuffer);
+
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint), NULL, GL_STREAM_DRAW);
+
+	glGenTextures(1, &indexTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, indexBuffer);
+
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	glGenBuffers(1, &clusterUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, clusterUBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(ClusterBlock), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+LightClusterer::~LightClusterer() {
+	glDeleteTextures(1, &clusterTexture);
+	glDeleteTextures(1, &indexTexture);
+	glDeleteBuffers(1, &clusterBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+	glDeleteBuffers(1, &clusterUBO);
+
+	delete workers;
+}
+
+void LightClusterer::setupProgram(GLuint program) {
+	GLuint blockIndex = glGetUniformBlockIndex(program, "Clusters");
+	if (blockIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, blockIndex, CLUSTER_BLOCK_BINDING);
+	else
+		cout << "Shader has no Clusters uniform block" << endl;
+
+	glUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "pointLights"), LIGHT_DATA_TEXTURE_UNIT);
+	glUniform1i(glGetUniformLocation(program, "clusters"), CLUSTER_TEXTURE_UNIT);
+	glUniform1i(glGetUniformLocation(program, "lightIndices"), LIGHT_INDEX_TEXTURE_UNIT);
+	glUseProgram(0);
+}
+
+void LightClusterer::setLights(const vector<glm::vec3> &positions, const vector<float> &radii) {
+	lightPositions = positions;
+	lightRadii = radii;
+}
+
+void LightClusterer::setGridSize(int x, int y, int z) {
+	clustersX = max(x, 1);
+	clustersY = max(y, 1);
+	clustersZ = max(z, 1);
+
+	clusterLights.assign(clustersX * clustersY * clustersZ, vector<GLuint>());
+	boundsValid = false;
+}
+
+// Depth slices are spaced so each is the same ratio deeper than the last
+int LightClusterer::sliceOf(float depth) {
+	int slice = (int)floor(log(depth / nearPlane) / log(farPlane / nearPlane) * clustersZ);
+
+	return min(max(slice, 0), clustersZ - 1);
+}
+
+// Each cluster is the part of a tile's frustum between two slice depths. The tile corners are
+// unprojected to rays at depth 1.
+void LightClusterer::computeClusterBounds(const glm::mat4 &projection) {
+	// Only a perspective projection's depth terms
+	nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+	farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+
+	glm::mat4 inverseProjection = glm::inverse(projection);
+
+	vector<glm::vec3> rays;
+	for (int y = 0; y <= clustersY; y++) {
+		for (int x = 0; x <= clustersX; x++) {
+			glm::vec4 ndc(x * 2.0f / clustersX - 1.0f, y * 2.0f / clustersY - 1.0f, -1.0f, 1.0f);
+			glm::vec4 view = inverseProjection * ndc;
+			glm::vec3 point = glm::vec3(view) / view.w;
+
+			rays.push_back(point / -point.z);
+		}
+	}
+
+	clusterBounds.resize(clustersX * clustersY * clustersZ);
+
+	for (int z = 0; z < clustersZ; z++) {
+		float depths[2] = {
+			nearPlane * pow(farPlane / nearPlane, z / (float)clustersZ),
+			nearPlane * pow(farPlane / nearPlane, (z + 1) / (float)clustersZ)
+		};
+
+		for (int y = 0; y < clustersY; y++) {
+			for (int x = 0; x < clustersX; x++) {
+				BoundingBox &bounds = clusterBounds[(z * clustersY + y) * clustersX + x];
+				bounds.min = glm::vec3(FLT_MAX);
+				bounds.max = glm::vec3(-FLT_MAX);
+
+				for (int corner = 0; corner < 8; corner++) {
+					const glm::vec3 &ray = rays[(y + ((corner >> 1) & 1)) * (clustersX + 1) + x + (corner & 1)];
+					glm::vec3 point = ray * depths[corner >> 2];
+
+					bounds.min = glm::min(bounds.min, point);
+					bounds.max = glm::max(bounds.max, point);
+				}
+			}
+		}
+	}
+
+	boundsProjection = projection;
+	boundsValid = true;
+}
+
+// Transforms this thread's share of the lights into view space and finds the clusters their bounds cover
+void LightClusterer::prepareLights(int threadIndex, const glm::mat4 &view, const glm::mat4 &projection) {
+	int threadCount = workers->getThreadCount();
+	int first = (int)(lightPositions.size() * threadIndex / threadCount);
+	int last = (int)(lightPositions.size() * (threadIndex + 1) / threadCount);
+
+	for (int i = first; i < last; i++) {
+		LightBin &bin = lightBins[i];
+		bin.centre = glm::vec3(view * glm::vec4(lightPositions[i], 1.0f));
+		bin.radius = lightRadii[i];
+
+		// Nothing to do for lights outside the depth range, an empty range skips them
+		float nearest = -bin.centre.z - bin.radius;
+		float farthest = -bin.centre.z + bin.radius;
+		if (farthest < nearPlane || nearest > farPlane) {
+			bin.minZ = 1;
+			bin.maxZ = 0;
+			continue;
+		}
+
+		bin.minZ = sliceOf(max(nearest, nearPlane));
+		bin.maxZ = sliceOf(min(farthest, farPlane));
+
+		bin.minX = 0;
+		bin.maxX = clustersX - 1;
+		bin.minY = 0;
+		bin.maxY = clustersY - 1;
+
+		// A sphere reaching past the near plane can cover any tile, otherwise its box is projected
+		if (nearest <= nearPlane)
+			continue;
+
+		glm::vec2 ndcMin(FLT_MAX);
+		glm::vec2 ndcMax(-FLT_MAX);
+
+		for (int corner = 0; corner < 8; corner++) {
+			glm::vec3 offset(corner & 1 ? bin.radius : -bin.radius, corner & 2 ? bin.radius : -bin.radius, corner & 4 ? bin.radius : -bin.radius);
+			glm::vec4 clip = projection * glm::vec4(bin.centre + offset, 1.0f);
+			glm::vec2 ndc = glm::vec2(clip) / clip.w;
+
+			ndcMin = glm::min(ndcMin, ndc);
+			ndcMax = glm::max(ndcMax, ndc);
+		}
+
+		bin.minX = max(0, (int)floor((ndcMin.x * 0.5f + 0.5f) * clustersX));
+		bin.maxX = min(clustersX - 1, (int)floor((ndcMax.x * 0.5f + 0.5f) * clustersX));
+		bin.minY = max(0, (int)floor((ndcMin.y * 0.5f + 0.5f) * clustersY));
+		bin.maxY = min(clustersY - 1, (int)floor((ndcMax.y * 0.5f + 0.5f) * clustersY));
+	}
+}
+
+// Fills the clusters of every slice this thread owns. Slices are interleaved between the threads
+// since the near ones are small and have few lights in them.
+void LightClusterer::binSlices(int threadIndex) {
+	int threadCount = workers->getThreadCount();
+
+	for (int z = threadIndex; z < clustersZ; z += threadCount) {
+		for (int c = z * clustersX * clustersY; c < (z + 1) * clustersX * clustersY; c++)
+			clusterLights[c].clear();
+
+		for (size_t i = 0; i < lightBins.size(); i++) {
+			const LightBin &bin = lightBins[i];
+			if (z < bin.minZ || z > bin.maxZ)
+				continue;
+
+			float radiusSquared = bin.radius * bin.radius;
+
+			for (int y = bin.minY; y <= bin.maxY; y++) {
+				for (int x = bin.minX; x <= bin.maxX; x++) {
+					int cluster = (z * clustersY + y) * clustersX + x;
+					const BoundingBox &bounds = clusterBounds[cluster];
+
+					// Distance from the centre to the nearest point of the box, written out since
+					// this runs for every light in every cluster it might touch
+					float dx = max(max(bounds.min.x - bin.centre.x, bin.centre.x - bounds.max.x), 0.0f);
+					float dy = max(max(bounds.min.y - bin.centre.y, bin.centre.y - bounds.max.y), 0.0f);
+					float dz = max(max(bounds.min.z - bin.centre.z, bin.centre.z - bounds.max.z), 0.0f);
+
+					if (dx * dx + dy * dy + dz * dz <= radiusSquared)
+						clusterLights[cluster].push_back((GLuint)i);
+				}
+			}
+		}
+	}
+}
+
+void LightClusterer::update(const glm::mat4 &view, const glm::mat4 &projection, const glm::mat4 &projectionOffset, int viewportWidth, int viewportHeight) {
+	auto start = chrono::high_resolution_clock::now();
+
+	if (!boundsValid || projection != boundsProjection)
+		computeClusterBounds(projection);
+
+	lightBins.resize(lightPositions.size());
+	workers->run([&](int threadIndex) { prepareLights(threadIndex, view, projection); });
+	workers->run([this](int threadIndex) { binSlices(threadIndex); });
+
+	// Packed in cluster order, the clusters' offsets are where their lists start
+	int clusterCount = clustersX * clustersY * clustersZ;
+	clusterData.resize(clusterCount * 2);
+	lightIndices.clear();
+
+	for (int c = 0; c < clusterCount; c++) {
+		GLuint offset = (GLuint)lightIndices.size();
+		GLuint count = (GLuint)clusterLights[c].size();
+
+		// A driver's buffer texture limit can be as low as 65536 texels, past that lights are dropped
+		if (offset + count > (GLuint)maxBufferTexels) {
+			count = (GLuint)maxBufferTexels - offset;
+
+			if (!overflowReported) {
+				cout << "Too many clustered lights for a " << maxBufferTexels << " texel buffer texture, some are dropped" << endl;
+				overflowReported = true;
+			}
+		}
+
+		clusterData[c * 2] = offset;
+		clusterData[c * 2 + 1] = count;
+		lightIndices.insert(lightIndices.end(), clusterLights[c].begin(), clusterLights[c].begin() + count);
+	}
+
+	// Buffer textures can't be empty
+	if (lightIndices.empty())
+		lightIndices.push_back(0);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, clusterBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, clusterData.size() * sizeof(GLuint), clusterData.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, lightIndices.size() * sizeof(GLuint), lightIndices.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	float logDepthRange = log(farPlane / nearPlane);
+
+	ClusterBlock block;
+	block.counts[0] = clustersX;
+	block.counts[1] = clustersY;
+	block.counts[2] = clustersZ;
+	block.counts[3] = 0;
+	// The offset maps the camera's NDC to the viewport's as ndc * scale + move on x and y. The shader
+	// takes a pixel back to the camera's NDC and on to a cluster in one multiply and add.
+	float scaleX = projectionOffset[0][0], moveX = projectionOffset[3][0];
+	float scaleY = projectionOffset[1][1], moveY = projectionOffset[3][1];
+
+	block.scale = glm::vec4(clustersX / (viewportWidth * scaleX), clustersY / (viewportHeight * scaleY),
+		clustersZ / logDepthRange, -clustersZ * log(nearPlane) / logDepthRange);
+	block.offset = glm::vec4(clustersX * (0.5f - (1.0f + moveX) / (2.0f * scaleX)),
+		clustersY * (0.5f - (1.0f + moveY) / (2.0f * scaleY)), 0.0f, 0.0f);
+	block.viewDepthRow = glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, clusterUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ClusterBlock), &block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	lastBinMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void LightClusterer::bind() {
+	glActiveTexture(GL_TEXTURE0 + CLUSTER_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, clusterTexture);
+	glActiveTexture(GL_TEXTURE0 + LIGHT_INDEX_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, CLUSTER_BLOCK_BINDING, clusterUBO);
+}
+
+float LightClusterer::getLastBinMs() {
+
+	return lastBinMs;
+}
+
+float LightClusterer::getAverageLightsPerCluster() {
+	size_t total = 0;
+	for (const vector<GLuint> &lights : clusterLights)
+		total += lights.size();
+
+	return (float)total / clusterLights.size();
+}
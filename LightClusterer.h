@@ -0,0 +1,118 @@
+#ifndef LIGHTCLUSTERER_H
+#define LIGHTCLUSTERER_H
+
+#include "Includes.h"
+#include "Frustum.h"
+#include "WorkerPool.h"
+#include <vector>
+
+// Texture units of the buffer textures the Phong shaders read lights through, unit 0 is the model's texture
+const int LIGHT_DATA_TEXTURE_UNIT = 1;
+const int CLUSTER_TEXTURE_UNIT = 2;
+const int LIGHT_INDEX_TEXTURE_UNIT = 3;
+
+// Uniform buffer binding point of the Clusters block
+const GLuint CLUSTER_BLOCK_BINDING = 1;
+
+// Clustered light culling for forward shading. The view volume is split into a grid of tiles on
+// screen and slices in depth (exponentially spaced, so clusters stay roughly cube shaped), and every
+// render each point light's sphere of influence is binned into the clusters it touches. A fragment
+// works out its cluster from gl_FragCoord and its view depth and only loops over that cluster's
+// lights, so the cost per fragment depends on how many lights reach it rather than on the total.
+//
+// Binning runs on a WorkerPool: the lights are transformed and given a cluster range split by light,
+// then each thread fills the clusters of its own depth slices. The (offset, count) of every cluster
+// and the light indices go to the shaders in buffer textures and the grid in the Clusters uniform
+// block, see Phong_shader.frag. The light data itself is the caller's, bound to LIGHT_DATA_TEXTURE_UNIT.
+class LightClusterer {
+	public:
+		static const int				DEFAULT_CLUSTERS_X = 16;
+		static const int				DEFAULT_CLUSTERS_Y = 9;
+		static const int				DEFAULT_CLUSTERS_Z = 24;
+
+	private:
+		// Mirrors the std140 Clusters block
+		struct ClusterBlock {
+			GLint						counts[4];
+			glm::vec4					scale;
+			glm::vec4					offset;
+			glm::vec4					viewDepthRow;
+		};
+
+		// A light in view space with the range of clusters its sphere's bounds cover
+		struct LightBin {
+			glm::vec3					centre;
+			float						radius;
+			int							minX, maxX;
+			int							minY, maxY;
+			int							minZ, maxZ;
+		};
+
+		int								clustersX = DEFAULT_CLUSTERS_X;
+		int								clustersY = DEFAULT_CLUSTERS_Y;
+		int								clustersZ = DEFAULT_CLUSTERS_Z;
+
+		WorkerPool						*workers;
+
+		std::vector<glm::vec3>			lightPositions;
+		std::vector<float>				lightRadii;
+		std::vector<LightBin>			lightBins;
+
+		// View space bounds of every cluster, only recomputed when the camera's projection changes.
+		// Jitter and tile offsets don't change them, the shader's cluster lookup undoes the offset.
+		std::vector<BoundingBox>		clusterBounds;
+		glm::mat4						boundsProjection;
+		bool							boundsValid = false;
+		float							nearPlane;
+		float							farPlane;
+
+		// Filled by each thread for its own slices, the capacity is kept between renders
+		std::vector<std::vector<GLuint>> clusterLights;
+
+		// What's uploaded: an offset and count for every cluster, then the indices they point into
+		std::vector<GLuint>				clusterData;
+		std::vector<GLuint>				lightIndices;
+		GLint							maxBufferTexels;
+		bool							overflowReported = false;
+
+		GLuint							clusterBuffer;
+		GLuint							clusterTexture;
+		GLuint							indexBuffer;
+		GLuint							indexTexture;
+		GLuint							clusterUBO;
+
+		float							lastBinMs = 0.0f;
+
+		void							computeClusterBounds(const glm::mat4 &projection);
+		void							prepareLights(int threadIndex, const glm::mat4 &view, const glm::mat4 &projection);
+		void							binSlices(int threadIndex);
+		int								sliceOf(float depth);
+
+	public:
+		// threads = 0 uses one per core
+		LightClusterer(int threads = 0);
+		~LightClusterer();
+
+		// Points the program's Clusters block and light samplers at the bindings used here
+		static void setupProgram(GLuint program);
+
+		// World space positions and the distance each light stops mattering at
+		void setLights(const std::vector<glm::vec3> &positions, const std::vector<float> &radii);
+
+		// 1 x 1 x 1 puts every light in one cluster, so every fragment loops over all of them
+		void setGridSize(int x, int y, int z);
+
+		// Bins the lights for this view and uploads the result. The scene is drawn with
+		// projectionOffset * projection into a viewportWidth x viewportHeight viewport, where the
+		// offset only scales and moves x and y (a jitter or tile, see TiledRenderer::tileProjection).
+		// The clusters always cover the camera's whole view, so the offset doesn't rebuild them.
+		void update(const glm::mat4 &view, const glm::mat4 &projection, const glm::mat4 &projectionOffset, int viewportWidth, int viewportHeight);
+
+		// Binds the cluster buffer textures and uniform block for drawing
+		void bind();
+
+		// CPU time of the last update() and the light indices it produced per cluster
+		float getLastBinMs();
+		float getAverageLightsPerCluster();
+};
+#endif
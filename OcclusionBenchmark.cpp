@@ -0,0 +1,188 @@
+#include "OcclusionBenchmark.h"
+#include "SoftwareOcclusion.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+static const int VIEWPOINTS = 8;
+static const int TIMED_RENDERS = 20;
+static const int TEST_BOXES = 4096;
+
+struct BenchSize {
+	int				width;
+	int				height;
+};
+
+static const BenchSize BENCH_SIZES[] = {
+	{ 256, 144 },
+	{ 512, 288 },
+};
+
+// Stand-in when the models aren't there: a bumpy 64 x 64 quad terrain and a few solid boxes on it
+static void addGeneratedOccluders(SoftwareOcclusion *occlusion) {
+	const int cells = 64;
+	const float size = 40.0f;
+
+	vector<glm::vec3> positions;
+	vector<unsigned int> indices;
+
+	for (int z = 0; z <= cells; z++) {
+		for (int x = 0; x <= cells; x++) {
+			float worldX = (x / (float)cells - 0.5f) * size;
+			float worldZ = (z / (float)cells - 0.5f) * size;
+			positions.push_back(glm::vec3(worldX, sin(worldX * 0.4f) * cos(worldZ * 0.3f) * 0.5f - 0.5f, worldZ));
+		}
+	}
+
+	for (int z = 0; z < cells; z++) {
+		for (int x = 0; x < cells; x++) {
+			unsigned int corner = z * (cells + 1) + x;
+			unsigned int quad[] = { corner, corner + 1, corner + cells + 2, corner, corner + cells + 2, corner + cells + 1 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+
+	occlusion->addOccluder(positions, indices, glm::mat4(1.0f));
+
+	vector<glm::vec3> cube;
+	for (int corner = 0; corner < 8; corner++)
+		cube.push_back(glm::vec3(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f));
+
+	vector<unsigned int> cubeIndices = {
+		0, 1, 3, 0, 3, 2,  4, 6, 7, 4, 7, 5,  0, 4, 5, 0, 5, 1,
+		2, 3, 7, 2, 7, 6,  0, 2, 6, 0, 6, 4,  1, 5, 7, 1, 7, 3
+	};
+
+	for (int i = 0; i < 6; i++) {
+		float angle = i * (6.2832f / 6.0f);
+		glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(cos(angle) * 5.0f, 0.5f, sin(angle) * 5.0f));
+		modelMatrix = glm::scale(modelMatrix, glm::vec3(1.5f, 1.5f, 1.5f));
+		occlusion->addOccluder(cube, cubeIndices, modelMatrix);
+	}
+}
+
+static double secondsSince(chrono::high_resolution_clock::time_point start) {
+
+	return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+}
+
+bool runOcclusionBenchmark() {
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+
+	// Circling the house at head height, looking at it
+	vector<glm::mat4> viewProjections;
+	for (int i = 0; i < VIEWPOINTS; i++) {
+		float angle = i * (6.2832f / VIEWPOINTS);
+		glm::vec3 eye(cos(angle) * 12.0f, 1.0f, sin(angle) * 12.0f);
+		viewProjections.push_back(projection * glm::lookAt(eye, glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+	}
+
+	// Boxes of every size scattered around the house, same ones every run
+	mt19937 random(1234);
+	uniform_real_distribution<float> position(-20.0f, 20.0f);
+	uniform_real_distribution<float> height(-0.5f, 3.0f);
+	uniform_real_distribution<float> extent(0.1f, 1.5f);
+
+	vector<BoundingBox> boxes;
+	for (int i = 0; i < TEST_BOXES; i++) {
+		glm::vec3 centre(position(random), height(random), position(random));
+		glm::vec3 halfSize(extent(random), extent(random), extent(random));
+
+		BoundingBox box;
+		box.min = centre - halfSize;
+		box.max = centre + halfSize;
+		boxes.push_back(box);
+	}
+
+	// Loaded once and copied into each culler as a triangle list
+	vector<glm::vec3> occluderVertices;
+	{
+		SoftwareOcclusion loader(SoftwareOcclusion::TILE_SIZE, SoftwareOcclusion::TILE_SIZE, 1);
+
+		bool house = loader.addOccluder("Resources/Models/house/house.obj", glm::mat4(1.0f));
+		bool land = loader.addOccluder("Resources/Models/land/land.obj", glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)));
+		if (!house && !land) {
+			cout << "Using generated occluders instead" << endl;
+			loader.clearOccluders();
+			addGeneratedOccluders(&loader);
+		}
+
+		occluderVertices = loader.getOccluderVertices();
+	}
+
+	if (occluderVertices.empty())
+		return false;
+
+	vector<unsigned int> occluderIndices(occluderVertices.size());
+	for (size_t i = 0; i < occluderIndices.size(); i++)
+		occluderIndices[i] = (unsigned int)i;
+
+	vector<int> threadCounts = { 1, 2, 4 };
+	int cores = (int)thread::hardware_concurrency();
+	if (cores > 4)
+		threadCounts.push_back(cores);
+
+	// Every SIMD path this CPU can run, the one the scene uses last
+	vector<const OcclusionKernels*> kernelSets;
+	if (getBestOcclusionKernels() != getBaselineOcclusionKernels())
+		kernelSets.push_back(getBaselineOcclusionKernels());
+	kernelSets.push_back(getBestOcclusionKernels());
+
+	printf("Software occlusion, %d viewpoints, %d renders and %d box tests per viewpoint, the scene uses %s\n",
+		VIEWPOINTS, TIMED_RENDERS, TEST_BOXES, getBestOcclusionKernels()->name);
+	if (!getCompiledAVX2OcclusionKernels())
+		printf("AVX2 path not built, this compiler couldn't enable AVX2 for OcclusionKernelsAVX2.cpp\n");
+	else if (!getAVX2OcclusionKernels())
+		printf("AVX2 path built but this CPU doesn't support it\n");
+	printf("%-6s %-9s %-7s %9s %11s %9s %10s %8s\n", "simd", "buffer", "threads", "triangles", "ms/render", "Mtris/s", "Mtests/s", "hidden");
+
+	bool measured = false;
+
+	for (const OcclusionKernels *kernels : kernelSets) {
+		for (const BenchSize &size : BENCH_SIZES) {
+			for (int threads : threadCounts) {
+				SoftwareOcclusion occlusion(size.width, size.height, threads);
+				occlusion.setKernels(kernels);
+				occlusion.addOccluder(occluderVertices, occluderIndices, glm::mat4(1.0f));
+
+				double renderSeconds = 0.0;
+				double testSeconds = 0.0;
+				long long triangles = 0;
+				int hidden = 0;
+
+				for (const glm::mat4 &viewProjection : viewProjections) {
+					occlusion.render(viewProjection);
+
+					auto start = chrono::high_resolution_clock::now();
+					for (int i = 0; i < TIMED_RENDERS; i++)
+						occlusion.render(viewProjection);
+					renderSeconds += secondsSince(start);
+					triangles += (long long)occlusion.getOccluderTriangleCount() * TIMED_RENDERS;
+
+					start = chrono::high_resolution_clock::now();
+					for (const BoundingBox &box : boxes) {
+						if (!occlusion.isVisible(box))
+							hidden++;
+					}
+					testSeconds += secondsSince(start);
+				}
+
+				int renders = VIEWPOINTS * TIMED_RENDERS;
+				int tests = VIEWPOINTS * TEST_BOXES;
+
+				printf("%-6s %4dx%-4d %-7d %9d %11.3f %9.2f %10.2f %7.1f%%\n", kernels->name, occlusion.getWidth(), occlusion.getHeight(),
+					occlusion.getThreadCount(), occlusion.getOccluderTriangleCount(), renderSeconds * 1000.0 / renders,
+					triangles / renderSeconds / 1e6, tests / testSeconds / 1e6, hidden * 100.0 / tests);
+				fflush(stdout);
+
+				measured = true;
+			}
+		}
+	}
+
+	return measured;
+}
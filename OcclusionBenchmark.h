@@ -0,0 +1,11 @@
+#ifndef OCCLUSIONBENCHMARK_H
+#define OCCLUSIONBENCHMARK_H
+
+// Times SoftwareOcclusion with the house and land as occluders (a generated terrain and boxes if they
+// can't be loaded) from several viewpoints, for a few buffer sizes and thread counts, and prints
+// occluder triangles rasterized per second and box tests per second. With AVX2 the SSE2 path is timed
+// too, each row says which one ran. Runs entirely on the CPU.
+// Returns false if there was nothing to rasterize.
+bool runOcclusionBenchmark();
+
+#endif
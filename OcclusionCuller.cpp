@@ -0,0 +1,136 @@
+#include "OcclusionCuller.h"
+#include "ShaderVariants.h"
+#include "VertexData.h"
+
+using namespace std;
+
+// Camera positions this close to a box count as inside it, the near plane would clip the box away
+static const float INSIDE_MARGIN = 0.2f;
+
+OcclusionCuller::OcclusionCuller() {
+	// The unit cube from VertexData.h, stretched over each box in the vertex shader
+	glGenVertexArrays(1, &cubeVAO);
+	glBindVertexArray(cubeVAO);
+
+	glGenBuffers(1, &cubeVertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, cubeVertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+	glGenBuffers(1, &cubeIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeVertexIndices), cubeVertexIndices, GL_STATIC_DRAW);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	GLSL_ERROR glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/OcclusionProxy_shader.vert"),
+		string("Resources/Shaders/OcclusionProxy_shader.frag"),
+		&proxyShader);
+
+	viewProjectionLocation = glGetUniformLocation(proxyShader, "viewProjectionMatrix");
+	boxMinLocation = glGetUniformLocation(proxyShader, "boxMin");
+	boxMaxLocation = glGetUniformLocation(proxyShader, "boxMax");
+}
+
+OcclusionCuller::~OcclusionCuller() {
+	for (Occludee &occludee : occludees)
+		glDeleteQueries(1, &occludee.query);
+
+	glDeleteVertexArrays(1, &cubeVAO);
+	glDeleteBuffers(1, &cubeVertexBuffer);
+	glDeleteBuffers(1, &cubeIndexBuffer);
+	glDeleteProgram(proxyShader);
+}
+
+int OcclusionCuller::add() {
+	occludees.push_back(Occludee());
+	glGenQueries(1, &occludees.back().query);
+
+	return (int)occludees.size() - 1;
+}
+
+bool OcclusionCuller::isVisible(int id, const BoundingBox &worldBounds, const glm::vec3 &cameraPos, GLuint *conditionQuery) {
+	Occludee &occludee = occludees[id];
+	*conditionQuery = 0;
+
+	bool inside = cameraPos.x > worldBounds.min.x - INSIDE_MARGIN && cameraPos.x < worldBounds.max.x + INSIDE_MARGIN
+		&& cameraPos.y > worldBounds.min.y - INSIDE_MARGIN && cameraPos.y < worldBounds.max.y + INSIDE_MARGIN
+		&& cameraPos.z > worldBounds.min.z - INSIDE_MARGIN && cameraPos.z < worldBounds.max.z + INSIDE_MARGIN;
+
+	// From inside the box there's nothing to test, the object is drawn and the old result forgotten
+	if (inside) {
+		occludee.issued = false;
+		occludee.visible = true;
+		occludee.testThisFrame = false;
+		return true;
+	}
+
+	occludee.bounds = worldBounds;
+	occludee.testThisFrame = true;
+
+	if (occludee.issued) {
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(occludee.query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available) {
+			GLint anySamples = GL_TRUE;
+			glGetQueryObjectiv(occludee.query, GL_QUERY_RESULT, &anySamples);
+			occludee.visible = anySamples != GL_FALSE;
+		} else {
+			// Let the GPU decide rather than wait for the result
+			*conditionQuery = occludee.query;
+			return true;
+		}
+	}
+
+	return occludee.visible;
+}
+
+void OcclusionCuller::reset(int id) {
+	occludees[id].issued = false;
+	occludees[id].visible = true;
+	occludees[id].testThisFrame = false;
+}
+
+void OcclusionCuller::issueQueries(const glm::mat4 &viewProjection) {
+	// Boxes only test against the depth buffer, and the whole of it (adaptive supersampling
+	// leaves the stencil test on for the scene)
+	GLboolean stencilTest = glIsEnabled(GL_STENCIL_TEST);
+	glDisable(GL_STENCIL_TEST);
+	glDisable(GL_CULL_FACE);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glDepthFunc(GL_LEQUAL);
+
+	glUseProgram(proxyShader);
+	glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+	glBindVertexArray(cubeVAO);
+
+	for (Occludee &occludee : occludees) {
+		if (!occludee.testThisFrame)
+			continue;
+
+		glUniform3f(boxMinLocation, occludee.bounds.min.x, occludee.bounds.min.y, occludee.bounds.min.z);
+		glUniform3f(boxMaxLocation, occludee.bounds.max.x, occludee.bounds.max.y, occludee.bounds.max.z);
+
+		glBeginQuery(GL_ANY_SAMPLES_PASSED, occludee.query);
+		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, 0);
+		glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+		occludee.issued = true;
+		occludee.testThisFrame = false;
+	}
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glEnable(GL_CULL_FACE);
+	if (stencilTest)
+		glEnable(GL_STENCIL_TEST);
+}
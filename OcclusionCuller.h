@@ -0,0 +1,54 @@
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include "Includes.h"
+#include "Frustum.h"
+#include <vector>
+
+// Skips objects hidden behind others using GL_ANY_SAMPLES_PASSED queries on their bounding boxes.
+// After the scene is drawn each box is rendered (no colour or depth writes) against the finished
+// depth buffer, and the next frame uses that result. Results that haven't come back yet are never
+// waited for: the draw is made conditional on the query instead (glBeginConditionalRender with
+// GL_QUERY_NO_WAIT), so the GPU skips it if the answer is there by then. An object that comes
+// into view therefore appears a frame late at worst, its box is still tested while it's skipped.
+class OcclusionCuller {
+	private:
+		struct Occludee {
+			GLuint						query;
+			bool						issued = false;
+			bool						visible = true;
+
+			// Set each frame for the objects whose boxes should be tested
+			bool						testThisFrame = false;
+			BoundingBox					bounds;
+		};
+		std::vector<Occludee>			occludees;
+
+		GLuint							cubeVAO;
+		GLuint							cubeVertexBuffer;
+		GLuint							cubeIndexBuffer;
+
+		GLuint							proxyShader;
+		GLint							viewProjectionLocation;
+		GLint							boxMinLocation;
+		GLint							boxMaxLocation;
+
+	public:
+		OcclusionCuller();
+		~OcclusionCuller();
+
+		// Returns the ID used for the object from now on
+		int add();
+
+		// Call once per frame for each object that passed the frustum test, before drawing anything.
+		// Returns false if the object was hidden last frame. Otherwise *conditionQuery is 0 to draw it
+		// normally, or a query to draw it conditionally on. The box is tested again either way.
+		bool isVisible(int id, const BoundingBox &worldBounds, const glm::vec3 &cameraPos, GLuint *conditionQuery);
+
+		// Forget the last result, for objects that left the view (it was for a different view by the time they're back)
+		void reset(int id);
+
+		// Draws the boxes passed to isVisible this frame against the current depth buffer
+		void issueQueries(const glm::mat4 &viewProjection);
+};
+#endif
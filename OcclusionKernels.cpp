@@ -0,0 +1,95 @@
+#include "OcclusionKernels.h"
+#include <cfloat>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_KERNELS_SSE
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(OCCLUSION_KERNELS_SSE)
+
+typedef __m128 Lanes;
+static const int LANES = 4;
+#define KERNELS_NAME "SSE2"
+
+static inline Lanes lanesSet(float value) { return _mm_set1_ps(value); }
+static inline Lanes lanesRamp() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+static inline Lanes lanesLoad(const float *p) { return _mm_loadu_ps(p); }
+static inline void lanesStore(float *p, Lanes value) { _mm_storeu_ps(p, value); }
+static inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+static inline Lanes lanesMul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+static inline Lanes lanesMin(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+static inline Lanes lanesMax(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+static inline Lanes lanesGreaterEqual(Lanes a, Lanes b) { return _mm_cmpge_ps(a, b); }
+static inline Lanes lanesAnd(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+static inline Lanes lanesSelect(Lanes mask, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline bool lanesAny(Lanes mask) { return _mm_movemask_ps(mask) != 0; }
+
+#else
+
+typedef float Lanes;
+static const int LANES = 1;
+#define KERNELS_NAME "scalar"
+
+static inline Lanes lanesSet(float value) { return value; }
+static inline Lanes lanesRamp() { return 0.0f; }
+static inline Lanes lanesLoad(const float *p) { return *p; }
+static inline void lanesStore(float *p, Lanes value) { *p = value; }
+static inline Lanes lanesAdd(Lanes a, Lanes b) { return a + b; }
+static inline Lanes lanesMul(Lanes a, Lanes b) { return a * b; }
+static inline Lanes lanesMin(Lanes a, Lanes b) { return a < b ? a : b; }
+static inline Lanes lanesMax(Lanes a, Lanes b) { return a > b ? a : b; }
+static inline Lanes lanesGreaterEqual(Lanes a, Lanes b) { return a >= b ? 1.0f : 0.0f; }
+static inline Lanes lanesAnd(Lanes a, Lanes b) { return a * b; }
+static inline Lanes lanesSelect(Lanes mask, Lanes a, Lanes b) { return mask != 0.0f ? a : b; }
+static inline bool lanesAny(Lanes mask) { return mask != 0.0f; }
+
+#endif
+
+#include "OcclusionKernels.inl"
+
+// AVX2 needs the CPU to have it and the OS to save the YMM registers on a context switch
+static bool cpuHasAVX2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// OSXSAVE and AVX
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	if ((_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	return false;
+#endif
+}
+
+const OcclusionKernels *getBaselineOcclusionKernels() {
+
+	return &kernels;
+}
+
+const OcclusionKernels *getAVX2OcclusionKernels() {
+	static const OcclusionKernels *avx2 = cpuHasAVX2() ? getCompiledAVX2OcclusionKernels() : nullptr;
+
+	return avx2;
+}
+
+const OcclusionKernels *getBestOcclusionKernels() {
+	const OcclusionKernels *avx2 = getAVX2OcclusionKernels();
+
+	return avx2 ? avx2 : getBaselineOcclusionKernels();
+}
@@ -0,0 +1,59 @@
+#ifndef OCCLUSIONKERNELS_H
+#define OCCLUSIONKERNELS_H
+
+// The pixel loops of OcclusionRasterizer, built once per instruction set from OcclusionKernels.inl.
+// The baseline (SSE2 on x86, plain C++ elsewhere) is built with the project's flags, the AVX2 version
+// is a separate file built with AVX2 enabled for it alone. Which one runs is picked at runtime with
+// cpuid, so the same executable works on CPUs without AVX2.
+//
+// Everything here is plain pointers and floats, so no std template can end up compiled with AVX2
+// instructions and shared with the baseline code by the linker.
+
+// Both sets work on rows of whole tiles, which have to be a multiple of the widest SIMD width
+static const int OCCLUSION_TILE_SIZE = 8;
+
+// Screen space triangle ready for rasterizing, the edges and depth are all a * x + b * y + c
+struct OcclusionTriangle {
+	float							edgeA[3];
+	float							edgeB[3];
+	float							edgeC[3];
+	float							depthA;
+	float							depthB;
+	float							depthC;
+
+	// Pixels whose centres can be inside
+	int								minX, maxX;
+	int								minY, maxY;
+};
+
+struct OcclusionKernels {
+	// "AVX2", "SSE2" or "scalar"
+	const char						*name;
+
+	// Pixels done at once
+	int								lanes;
+
+	// Draws the triangles into rows rowStart to rowEnd of depth (width floats per row), keeping the nearest
+	void							(*rasterize)(float *depth, int width, int rowStart, int rowEnd, const OcclusionTriangle *triangles, int triangleCount);
+
+	// Farthest depth of each of the tilesX tiles in the row of tiles starting at rowStart
+	void							(*tileMaxDepth)(const float *depth, int width, int rowStart, int tilesX, float *tileMax);
+
+	// True if a pixel in startX to endX, startY to endY is at or behind boxDepth. Tiles whose farthest
+	// depth (tileMax, tilesX per row) is in front of boxDepth are skipped without reading their pixels.
+	bool							(*anyBehind)(const float *depth, int width, const float *tileMax, int tilesX, int startX, int endX, int startY, int endY, float boxDepth);
+};
+
+// SSE2 on x86, plain C++ elsewhere
+const OcclusionKernels *getBaselineOcclusionKernels();
+
+// nullptr if they weren't built or this CPU can't run them
+const OcclusionKernels *getAVX2OcclusionKernels();
+
+// AVX2 when it can run, the baseline otherwise
+const OcclusionKernels *getBestOcclusionKernels();
+
+// OcclusionKernelsAVX2.cpp's table, nullptr if that file was built without AVX2. Use getAVX2OcclusionKernels().
+const OcclusionKernels *getCompiledAVX2OcclusionKernels();
+
+#endif
@@ -0,0 +1,111 @@
+// The loops behind OcclusionKernels, included by OcclusionKernels.cpp and OcclusionKernelsAVX2.cpp.
+// Before including it a file defines the Lanes type, LANES, KERNELS_NAME and the lanes functions below
+// for its instruction set. A "mask" is all bits set in the lanes where a comparison held (or 1/0 in
+// the scalar version).
+//
+// Only static functions, so each file gets its own copy compiled with its own flags.
+
+// A tile row is a whole number of lane groups, so rows never need a partial group
+static_assert(OCCLUSION_TILE_SIZE % LANES == 0, "tiles must be a multiple of the SIMD width");
+
+static void rasterizeTriangles(float *depth, int width, int rowStart, int rowEnd, const OcclusionTriangle *triangles, int triangleCount) {
+	Lanes ramp = lanesAdd(lanesRamp(), lanesSet(0.5f));
+	Lanes zero = lanesSet(0.0f);
+
+	for (int t = 0; t < triangleCount; t++) {
+		const OcclusionTriangle &triangle = triangles[t];
+
+		if (triangle.maxY < rowStart || triangle.minY > rowEnd)
+			continue;
+
+		int startY = triangle.minY > rowStart ? triangle.minY : rowStart;
+		int endY = triangle.maxY < rowEnd ? triangle.maxY : rowEnd;
+
+		// Lane groups start on multiples of LANES, the edge test masks off pixels left of minX
+		int startX = triangle.minX - triangle.minX % LANES;
+
+		Lanes edgeA0 = lanesSet(triangle.edgeA[0]);
+		Lanes edgeA1 = lanesSet(triangle.edgeA[1]);
+		Lanes edgeA2 = lanesSet(triangle.edgeA[2]);
+		Lanes depthA = lanesSet(triangle.depthA);
+
+		for (int y = startY; y <= endY; y++) {
+			float pixelY = y + 0.5f;
+			float *row = depth + y * width;
+
+			Lanes rowEdge0 = lanesSet(triangle.edgeB[0] * pixelY + triangle.edgeC[0]);
+			Lanes rowEdge1 = lanesSet(triangle.edgeB[1] * pixelY + triangle.edgeC[1]);
+			Lanes rowEdge2 = lanesSet(triangle.edgeB[2] * pixelY + triangle.edgeC[2]);
+			Lanes rowDepth = lanesSet(triangle.depthB * pixelY + triangle.depthC);
+
+			for (int x = startX; x <= triangle.maxX; x += LANES) {
+				Lanes pixelX = lanesAdd(lanesSet((float)x), ramp);
+
+				Lanes inside = lanesGreaterEqual(lanesAdd(lanesMul(edgeA0, pixelX), rowEdge0), zero);
+				inside = lanesAnd(inside, lanesGreaterEqual(lanesAdd(lanesMul(edgeA1, pixelX), rowEdge1), zero));
+				inside = lanesAnd(inside, lanesGreaterEqual(lanesAdd(lanesMul(edgeA2, pixelX), rowEdge2), zero));
+
+				if (!lanesAny(inside))
+					continue;
+
+				Lanes pixelDepth = lanesAdd(lanesMul(depthA, pixelX), rowDepth);
+				Lanes current = lanesLoad(row + x);
+				lanesStore(row + x, lanesSelect(inside, lanesMin(current, pixelDepth), current));
+			}
+		}
+	}
+}
+
+static void computeTileMaxDepth(const float *depth, int width, int rowStart, int tilesX, float *tileMax) {
+	for (int tileX = 0; tileX < tilesX; tileX++) {
+		Lanes farthest = lanesSet(-FLT_MAX);
+
+		for (int y = rowStart; y < rowStart + OCCLUSION_TILE_SIZE; y++) {
+			for (int x = tileX * OCCLUSION_TILE_SIZE; x < (tileX + 1) * OCCLUSION_TILE_SIZE; x += LANES)
+				farthest = lanesMax(farthest, lanesLoad(depth + y * width + x));
+		}
+
+		float lanes[LANES];
+		lanesStore(lanes, farthest);
+
+		float tileFarthest = lanes[0];
+		for (int i = 1; i < LANES; i++)
+			tileFarthest = lanes[i] > tileFarthest ? lanes[i] : tileFarthest;
+		tileMax[tileX] = tileFarthest;
+	}
+}
+
+static bool anyPixelBehind(const float *depth, int width, const float *tileMax, int tilesX, int startX, int endX, int startY, int endY, float boxDepth) {
+	Lanes behindDepth = lanesSet(boxDepth);
+	Lanes ramp = lanesRamp();
+	Lanes firstX = lanesSet((float)startX);
+	Lanes lastX = lanesSet((float)endX);
+
+	for (int tileY = startY / OCCLUSION_TILE_SIZE; tileY <= endY / OCCLUSION_TILE_SIZE; tileY++) {
+		for (int tileX = startX / OCCLUSION_TILE_SIZE; tileX <= endX / OCCLUSION_TILE_SIZE; tileX++) {
+			// Everything drawn in the tile is nearer than the box
+			if (tileMax[tileY * tilesX + tileX] < boxDepth)
+				continue;
+
+			int tileStartY = tileY * OCCLUSION_TILE_SIZE > startY ? tileY * OCCLUSION_TILE_SIZE : startY;
+			int tileEndY = tileY * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1 < endY ? tileY * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1 : endY;
+
+			for (int y = tileStartY; y <= tileEndY; y++) {
+				const float *row = depth + y * width;
+
+				for (int x = tileX * OCCLUSION_TILE_SIZE; x < (tileX + 1) * OCCLUSION_TILE_SIZE; x += LANES) {
+					Lanes pixelX = lanesAdd(lanesSet((float)x), ramp);
+					Lanes inBox = lanesAnd(lanesGreaterEqual(pixelX, firstX), lanesGreaterEqual(lastX, pixelX));
+					Lanes behind = lanesGreaterEqual(lanesLoad(row + x), behindDepth);
+
+					if (lanesAny(lanesAnd(inBox, behind)))
+						return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+static const OcclusionKernels kernels = { KERNELS_NAME, LANES, rasterizeTriangles, computeTileMaxDepth, anyPixelBehind };
@@ -0,0 +1,40 @@
+// Built with AVX2 enabled for this file only (AdvancedVectorExtensions2 in the project, -mavx2 with
+// CMake), nothing in here runs unless getAVX2OcclusionKernels() found AVX2 on the CPU
+#include "OcclusionKernels.h"
+#include <cfloat>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+typedef __m256 Lanes;
+static const int LANES = 8;
+#define KERNELS_NAME "AVX2"
+
+static inline Lanes lanesSet(float value) { return _mm256_set1_ps(value); }
+static inline Lanes lanesRamp() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+static inline Lanes lanesLoad(const float *p) { return _mm256_loadu_ps(p); }
+static inline void lanesStore(float *p, Lanes value) { _mm256_storeu_ps(p, value); }
+static inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+static inline Lanes lanesMul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+static inline Lanes lanesMin(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+static inline Lanes lanesMax(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+static inline Lanes lanesGreaterEqual(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline Lanes lanesAnd(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+static inline Lanes lanesSelect(Lanes mask, Lanes a, Lanes b) { return _mm256_blendv_ps(b, a, mask); }
+static inline bool lanesAny(Lanes mask) { return _mm256_movemask_ps(mask) != 0; }
+
+#include "OcclusionKernels.inl"
+
+const OcclusionKernels *getCompiledAVX2OcclusionKernels() {
+
+	return &kernels;
+}
+
+#else
+
+const OcclusionKernels *getCompiledAVX2OcclusionKernels() {
+
+	return nullptr;
+}
+
+#endif
@@ -0,0 +1,252 @@
+#include "OcclusionRasterizer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+
+OcclusionRasterizer::OcclusionRasterizer(int newWidth, int newHeight, int threads) {
+	tilesX = (max(newWidth, 1) + TILE_SIZE - 1) / TILE_SIZE;
+	tilesY = (max(newHeight, 1) + TILE_SIZE - 1) / TILE_SIZE;
+	width = tilesX * TILE_SIZE;
+	height = tilesY * TILE_SIZE;
+
+	workers = new WorkerPool(threads, tilesY);
+	kernels = getBestOcclusionKernels();
+
+	depth.assign(width * height, 1.0f);
+	tileMaxDepth.assign(tilesX * tilesY, 1.0f);
+	screenTriangles.resize(workers->getThreadCount());
+}
+
+OcclusionRasterizer::~OcclusionRasterizer() {
+	delete workers;
+}
+
+void OcclusionRasterizer::addOccluder(const vector<glm::vec3> &positions, const vector<unsigned int> &indices, const glm::mat4 &modelMatrix) {
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		for (int corner = 0; corner < 3; corner++)
+			occluderVertices.push_back(glm::vec3(modelMatrix * glm::vec4(positions[indices[i + corner]], 1.0f)));
+	}
+}
+
+void OcclusionRasterizer::clearOccluders() {
+	occluderVertices.clear();
+}
+
+int OcclusionRasterizer::getOccluderTriangleCount() {
+
+	return (int)occluderVertices.size() / 3;
+}
+
+const vector<glm::vec3>& OcclusionRasterizer::getOccluderVertices() {
+
+	return occluderVertices;
+}
+
+void OcclusionRasterizer::render(const glm::mat4 &newViewProjection) {
+	viewProjection = newViewProjection;
+
+	// Every thread needs every triangle to rasterize its rows, so all of them are set up first
+	workers->run([this](int threadIndex) { setupTriangles(threadIndex); });
+
+	workers->run([this](int threadIndex) {
+		// Interleaved so the rows with the most triangles (usually the middle) are shared out
+		for (int tileRow = threadIndex; tileRow < tilesY; tileRow += workers->getThreadCount())
+			rasterizeTileRow(tileRow);
+	});
+}
+
+// Transforms and near clips this thread's share of the occluder triangles
+void OcclusionRasterizer::setupTriangles(int threadIndex) {
+	vector<OcclusionTriangle> &triangles = screenTriangles[threadIndex];
+	triangles.clear();
+
+	int triangleCount = getOccluderTriangleCount();
+	int threadCount = workers->getThreadCount();
+	int firstTriangle = (int)((long long)triangleCount * threadIndex / threadCount);
+	int lastTriangle = (int)((long long)triangleCount * (threadIndex + 1) / threadCount);
+
+	for (int t = firstTriangle; t < lastTriangle; t++) {
+		glm::vec4 clip[3];
+		float nearDistance[3];
+		int inFront = 0;
+
+		for (int i = 0; i < 3; i++) {
+			clip[i] = viewProjection * glm::vec4(occluderVertices[t * 3 + i], 1.0f);
+
+			// Positive on the visible side of the near plane (z = -w)
+			nearDistance[i] = clip[i].z + clip[i].w;
+			if (nearDistance[i] >= 0.0f)
+				inFront++;
+		}
+
+		if (inFront == 3) {
+			addTriangle(clip, &triangles);
+			continue;
+		}
+		if (inFront == 0)
+			continue;
+
+		// Clip against the near plane, leaving a triangle or a quad
+		glm::vec4 polygon[4];
+		int polygonSize = 0;
+
+		for (int i = 0; i < 3; i++) {
+			int next = (i + 1) % 3;
+
+			if (nearDistance[i] >= 0.0f)
+				polygon[polygonSize++] = clip[i];
+
+			if ((nearDistance[i] >= 0.0f) != (nearDistance[next] >= 0.0f)) {
+				float along = nearDistance[i] / (nearDistance[i] - nearDistance[next]);
+				polygon[polygonSize++] = clip[i] + (clip[next] - clip[i]) * along;
+			}
+		}
+
+		glm::vec4 firstHalf[3] = { polygon[0], polygon[1], polygon[2] };
+		addTriangle(firstHalf, &triangles);
+
+		if (polygonSize == 4) {
+			glm::vec4 secondHalf[3] = { polygon[0], polygon[2], polygon[3] };
+			addTriangle(secondHalf, &triangles);
+		}
+	}
+}
+
+void OcclusionRasterizer::addTriangle(const glm::vec4 clip[3], vector<OcclusionTriangle> *triangles) {
+	float x[3], y[3], z[3];
+
+	for (int i = 0; i < 3; i++) {
+		// Clipped vertices can end up exactly on the near plane where w can be 0 for odd projections
+		if (clip[i].w <= 0.0f)
+			return;
+
+		float inverseW = 1.0f / clip[i].w;
+		x[i] = (clip[i].x * inverseW * 0.5f + 0.5f) * width;
+		y[i] = (clip[i].y * inverseW * 0.5f + 0.5f) * height;
+		z[i] = clip[i].z * inverseW;
+	}
+
+	// Nothing to gain from triangles that are completely behind everything already
+	if (z[0] >= 1.0f && z[1] >= 1.0f && z[2] >= 1.0f)
+		return;
+
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (fabs(area) < 1e-8f)
+		return;
+
+	OcclusionTriangle triangle;
+	triangle.minX = max(0, (int)ceil(min(x[0], min(x[1], x[2])) - 0.5f));
+	triangle.maxX = min(width - 1, (int)floor(max(x[0], max(x[1], x[2])) - 0.5f));
+	triangle.minY = max(0, (int)ceil(min(y[0], min(y[1], y[2])) - 0.5f));
+	triangle.maxY = min(height - 1, (int)floor(max(y[0], max(y[1], y[2])) - 0.5f));
+
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+		return;
+
+	// Occluders are drawn from both sides, so the edges are flipped for clockwise triangles to
+	// keep the inside positive
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+
+	for (int i = 0; i < 3; i++) {
+		int next = (i + 1) % 3;
+		triangle.edgeA[i] = (y[i] - y[next]) * sign;
+		triangle.edgeB[i] = (x[next] - x[i]) * sign;
+		triangle.edgeC[i] = (x[i] * y[next] - x[next] * y[i]) * sign;
+	}
+
+	triangle.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	triangle.depthB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+	triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0];
+
+	triangles->push_back(triangle);
+}
+
+// Clears and draws every triangle into one row of tiles, then updates those tiles' farthest depth
+void OcclusionRasterizer::rasterizeTileRow(int tileRow) {
+	int rowStart = tileRow * TILE_SIZE;
+	int rowEnd = rowStart + TILE_SIZE - 1;
+
+	fill(depth.begin() + rowStart * width, depth.begin() + (rowEnd + 1) * width, 1.0f);
+
+	for (const vector<OcclusionTriangle> &triangles : screenTriangles)
+		kernels->rasterize(depth.data(), width, rowStart, rowEnd, triangles.data(), (int)triangles.size());
+
+	kernels->tileMaxDepth(depth.data(), width, rowStart, tilesX, &tileMaxDepth[tileRow * tilesX]);
+}
+
+int OcclusionRasterizer::getRasterizedTriangleCount() {
+	int count = 0;
+
+	for (const vector<OcclusionTriangle> &triangles : screenTriangles)
+		count += (int)triangles.size();
+
+	return count;
+}
+
+bool OcclusionRasterizer::isVisible(const glm::vec3 &boxMin, const glm::vec3 &boxMax) const {
+	float minX = FLT_MAX, maxX = -FLT_MAX;
+	float minY = FLT_MAX, maxY = -FLT_MAX;
+	float nearestDepth = FLT_MAX;
+
+	for (int corner = 0; corner < 8; corner++) {
+		glm::vec3 position(corner & 1 ? boxMax.x : boxMin.x, corner & 2 ? boxMax.y : boxMin.y, corner & 4 ? boxMax.z : boxMin.z);
+		glm::vec4 clip = viewProjection * glm::vec4(position, 1.0f);
+
+		// Part of the box is in front of the near plane, the camera could be inside it
+		if (clip.z + clip.w < 0.0f || clip.w <= 0.0f)
+			return true;
+
+		float inverseW = 1.0f / clip.w;
+		float x = (clip.x * inverseW * 0.5f + 0.5f) * width;
+		float y = (clip.y * inverseW * 0.5f + 0.5f) * height;
+
+		minX = min(minX, x);
+		maxX = max(maxX, x);
+		minY = min(minY, y);
+		maxY = max(maxY, y);
+		nearestDepth = min(nearestDepth, clip.z * inverseW);
+	}
+
+	// Every pixel the box's outline touches, not just the ones whose centres it covers
+	int startX = max(0, (int)floor(minX));
+	int endX = min(width - 1, (int)ceil(maxX) - 1);
+	int startY = max(0, (int)floor(minY));
+	int endY = min(height - 1, (int)ceil(maxY) - 1);
+
+	// Completely off screen, the frustum test should already have caught it
+	if (startX > endX || startY > endY)
+		return false;
+
+	return kernels->anyBehind(depth.data(), width, tileMaxDepth.data(), tilesX, startX, endX, startY, endY, nearestDepth);
+}
+
+void OcclusionRasterizer::setKernels(const OcclusionKernels *newKernels) {
+	kernels = newKernels;
+}
+
+const OcclusionKernels* OcclusionRasterizer::getKernels() {
+
+	return kernels;
+}
+
+int OcclusionRasterizer::getWidth() {
+
+	return width;
+}
+
+int OcclusionRasterizer::getHeight() {
+
+	return height;
+}
+
+int OcclusionRasterizer::getThreadCount() {
+
+	return workers->getThreadCount();
+}
+
+const vector<float>& OcclusionRasterizer::getDepthBuffer() {
+
+	return depth;
+}
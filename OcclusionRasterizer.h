@@ -0,0 +1,84 @@
+#ifndef OCCLUSIONRASTERIZER_H
+#define OCCLUSIONRASTERIZER_H
+
+#include "OcclusionKernels.h"
+#include "WorkerPool.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+// The depth buffer behind SoftwareOcclusion. Occluder triangles are rasterized into a small depth
+// buffer and boxes are tested against it, all on the CPU. Only needs GLM, so it can be used and
+// tested without a GL context; SoftwareOcclusion adds loading occluders from model files and
+// testing the scene's BoundingBoxes.
+//
+// The buffer is split into TILE_SIZE x TILE_SIZE tiles which also keep their farthest depth, so a
+// test only looks at pixels in tiles that aren't completely in front of the box. Each row of tiles is
+// rasterized by one thread, and the pixel loops work on 8 pixels at once with AVX2 or 4 with SSE2
+// (see OcclusionKernels). Depth is taken at pixel centres, so gaps in the occluders narrower than a
+// pixel count as solid.
+class OcclusionRasterizer {
+	public:
+		static const int				TILE_SIZE = OCCLUSION_TILE_SIZE;
+
+	private:
+		// Width is rounded up to a whole number of tiles, height too
+		int								width;
+		int								height;
+		int								tilesX;
+		int								tilesY;
+
+		// NDC depth, bottom row first. 1 where no occluder has been drawn.
+		std::vector<float>				depth;
+		std::vector<float>				tileMaxDepth;
+
+		// World space occluder triangles, three positions each
+		std::vector<glm::vec3>			occluderVertices;
+
+		// Set up by render(), one list per thread so they can be filled at the same time
+		std::vector<std::vector<OcclusionTriangle>> screenTriangles;
+		glm::mat4						viewProjection;
+
+		const OcclusionKernels			*kernels;
+
+		void							setupTriangles(int threadIndex);
+		void							addTriangle(const glm::vec4 clip[3], std::vector<OcclusionTriangle> *triangles);
+		void							rasterizeTileRow(int tileRow);
+
+		// One thread per row of tiles at most
+		WorkerPool						*workers;
+
+	public:
+		// threads = 0 uses one per core (at most one per row of tiles)
+		OcclusionRasterizer(int newWidth, int newHeight, int threads = 0);
+		~OcclusionRasterizer();
+
+		// Adds a mesh that hides what's behind it. Only closed, solid meshes should be used.
+		void addOccluder(const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &indices, const glm::mat4 &modelMatrix);
+
+		void clearOccluders();
+		int getOccluderTriangleCount();
+
+		// World space, three per triangle
+		const std::vector<glm::vec3>& getOccluderVertices();
+
+		// Clears the depth buffer and rasterizes all the occluders seen through viewProjection
+		void render(const glm::mat4 &newViewProjection);
+
+		// Triangles left after near plane clipping and dropping ones that cover no pixel centres
+		int getRasterizedTriangleCount();
+
+		// False if the world space box is certainly hidden behind the occluders drawn by the last
+		// render(). Boxes crossing the near plane are always visible. Safe to call from several
+		// threads at once.
+		bool isVisible(const glm::vec3 &boxMin, const glm::vec3 &boxMax) const;
+
+		// The best the CPU can run unless set otherwise, e.g. to compare them
+		void setKernels(const OcclusionKernels *newKernels);
+		const OcclusionKernels* getKernels();
+
+		int getWidth();
+		int getHeight();
+		int getThreadCount();
+		const std::vector<float>& getDepthBuffer();
+};
+#endif
@@ -0,0 +1,149 @@
+#include "PostProcessAA.h"
+#include "ShaderVariants.h"
+#include <iostream>
+
+using namespace std;
+
+// All the passes draw a fullscreen triangle and read their inputs from units 0 and 1
+static GLuint loadPass(const char *fragmentShader, const char *texture1Name = nullptr) {
+	GLuint shader;
+	GLSL_ERROR glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string(fragmentShader),
+		&shader);
+
+	glUseProgram(shader);
+	glUniform1i(glGetUniformLocation(shader, "texture0"), 0);
+	if (texture1Name)
+		glUniform1i(glGetUniformLocation(shader, texture1Name), 1);
+	glUseProgram(0);
+
+	return shader;
+}
+
+PostProcessAA::PostProcessAA(PostProcessAAMode newMode, int newOutputWidth, int newOutputHeight) {
+	mode = newMode;
+	outputWidth = newOutputWidth;
+	outputHeight = newOutputHeight;
+
+	fxaaShader = 0;
+	edgesShader = 0;
+	weightsShader = 0;
+	blendShader = 0;
+	edgesFBO = weightsFBO = 0;
+	edgesTexture = weightsTexture = 0;
+
+	fboOkay = true;
+
+	if (mode == POSTAA_FXAA) {
+		fxaaShader = loadPass("Resources/Shaders/FXAA_shader.frag");
+	} else {
+		edgesShader = loadPass("Resources/Shaders/SMAAEdges_shader.frag");
+		weightsShader = loadPass("Resources/Shaders/SMAAWeights_shader.frag");
+		blendShader = loadPass("Resources/Shaders/SMAABlend_shader.frag", "weightsTexture");
+
+		// The weights pass names its input edgesTexture rather than texture0
+		glUseProgram(weightsShader);
+		glUniform1i(glGetUniformLocation(weightsShader, "edgesTexture"), 0);
+		glUseProgram(0);
+
+		edgesFBO = createTarget(GL_RG8, GL_NEAREST, &edgesTexture);
+		weightsFBO = createTarget(GL_RG16F, GL_NEAREST, &weightsTexture);
+	}
+
+	outputFBO = createTarget(GL_RGBA8, GL_LINEAR, &outputTexture);
+
+	glGenVertexArrays(1, &emptyVAO);
+}
+
+PostProcessAA::~PostProcessAA() {
+	glDeleteFramebuffers(1, &outputFBO);
+	glDeleteTextures(1, &outputTexture);
+
+	if (edgesFBO) {
+		glDeleteFramebuffers(1, &edgesFBO);
+		glDeleteFramebuffers(1, &weightsFBO);
+		glDeleteTextures(1, &edgesTexture);
+		glDeleteTextures(1, &weightsTexture);
+	}
+
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(fxaaShader);
+	glDeleteProgram(edgesShader);
+	glDeleteProgram(weightsShader);
+	glDeleteProgram(blendShader);
+}
+
+GLuint PostProcessAA::createTarget(GLint internalFormat, GLint filter, GLuint *texture) {
+	GLuint fbo;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+	glGenTextures(1, texture);
+	glBindTexture(GL_TEXTURE_2D, *texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, outputWidth, outputHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, *texture, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		fboOkay = false;
+		cout << "Could not successfully create framebuffer object for post-process AA!" << endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return fbo;
+}
+
+void PostProcessAA::runPass(GLuint shader, GLuint targetFBO, GLuint texture0, GLuint texture1) {
+	glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+	glViewport(0, 0, outputWidth, outputHeight);
+
+	glUseProgram(shader);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture0);
+	if (texture1) {
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture1);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void PostProcessAA::apply(GLuint sourceTexture) {
+	if (!fboOkay)
+		return;
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+	glBindVertexArray(emptyVAO);
+
+	if (mode == POSTAA_FXAA) {
+		runPass(fxaaShader, outputFBO, sourceTexture);
+	} else {
+		// The edge pass discards pixels without edges, so clear what the last frame left behind
+		glBindFramebuffer(GL_FRAMEBUFFER, edgesFBO);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		runPass(edgesShader, edgesFBO, sourceTexture);
+		runPass(weightsShader, weightsFBO, edgesTexture);
+		runPass(blendShader, outputFBO, sourceTexture, weightsTexture);
+	}
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GLuint PostProcessAA::getOutputTexture() {
+	return outputTexture;
+}
@@ -0,0 +1,48 @@
+#ifndef POSTPROCESSAA_H
+#define POSTPROCESSAA_H
+
+#include "Includes.h"
+
+enum PostProcessAAMode { POSTAA_FXAA, POSTAA_SMAA };
+
+// Anti-aliasing done as fullscreen passes over the 1x scene colour, so the scene is shaded once
+// per pixel like with no AA at all.
+// FXAA is a single pass. SMAA mode is a morphological filter in the style of SMAA 1x: luma edge
+// detection, blending weights from the shape of each edge, then blending with the neighbours.
+class PostProcessAA {
+	private:
+		PostProcessAAMode				mode;
+
+		int								outputWidth;
+		int								outputHeight;
+
+		// SMAA intermediates: edges (RG8) and signed blending weights (RG16F)
+		GLuint							edgesFBO;
+		GLuint							edgesTexture;
+		GLuint							weightsFBO;
+		GLuint							weightsTexture;
+
+		GLuint							outputFBO;
+		GLuint							outputTexture;
+
+		bool							fboOkay;
+
+		GLuint							emptyVAO;
+
+		GLuint							fxaaShader;
+		GLuint							edgesShader;
+		GLuint							weightsShader;
+		GLuint							blendShader;
+
+		GLuint							createTarget(GLint internalFormat, GLint filter, GLuint *texture);
+		void							runPass(GLuint shader, GLuint targetFBO, GLuint texture0, GLuint texture1 = 0);
+
+	public:
+		PostProcessAA(PostProcessAAMode newMode, int newOutputWidth, int newOutputHeight);
+		~PostProcessAA();
+
+		void apply(GLuint sourceTexture);
+
+		GLuint getOutputTexture();
+};
+#endif
@@ -0,0 +1,202 @@
+#include "ProgramBinaryCache.h"
+#include "GLExtensions.h"
+#include "FrameCapture.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+string ProgramBinaryCache::directory = "ShaderCache";
+bool ProgramBinaryCache::enabled = true;
+bool ProgramBinaryCache::directoryCreated = false;
+
+int ProgramBinaryCache::loadedCount = 0;
+int ProgramBinaryCache::compiledCount = 0;
+int ProgramBinaryCache::rejectedCount = 0;
+double ProgramBinaryCache::loadMs = 0.0;
+double ProgramBinaryCache::compileMs = 0.0;
+
+// Start of every cache file, the length is checked against what's actually in the file so a
+// half written one is never handed to the driver
+struct BinaryHeader {
+	char							magic[4];
+	GLenum							format;
+	GLint							length;
+};
+
+static const char BINARY_MAGIC[4] = { 'P', 'B', 'I', 'N' };
+
+// FNV-1a, 64 bits so collisions between the few dozen programs here aren't a concern
+static uint64_t hashString(const string &text, uint64_t hash = 14695981039346656037ull) {
+	for (unsigned char c : text) {
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+static string glString(GLenum name) {
+	const GLubyte *value = glGetString(name);
+
+	return value ? string((const char*)value) : string();
+}
+
+void ProgramBinaryCache::setDirectory(const string &path) {
+	directory = path;
+	directoryCreated = false;
+}
+
+void ProgramBinaryCache::setEnabled(bool newEnabled) {
+	enabled = newEnabled;
+}
+
+bool ProgramBinaryCache::isAvailable() {
+	if (!enabled || !GLExtensions::getProgramBinary || !GLExtensions::programBinary)
+		return false;
+
+	// Drivers can support the entry points but have no formats to give out (Mesa without a disk cache)
+	static GLint formats = -1;
+	if (formats < 0)
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+	return formats > 0;
+}
+
+string ProgramBinaryCache::makeKey(const string &vertexSource, const string &fragmentSource, const string &defines) {
+	// Separators stop "ab" + "c" hashing the same as "a" + "bc"
+	uint64_t hash = hashString(vertexSource);
+	hash = hashString("\x1f" + fragmentSource, hash);
+	hash = hashString("\x1f" + defines, hash);
+	hash = hashString("\x1f" + glString(GL_VENDOR) + "\x1f" + glString(GL_RENDERER) + "\x1f" + glString(GL_VERSION), hash);
+
+	char key[17];
+	snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+	return key;
+}
+
+string ProgramBinaryCache::filePath(const string &key) {
+
+	return directory + "/" + key + ".bin";
+}
+
+GLuint ProgramBinaryCache::load(const string &key) {
+	if (!isAvailable())
+		return 0;
+
+	ifstream file(filePath(key), ios::binary);
+	if (!file)
+		return 0;
+
+	BinaryHeader header;
+	vector<char> binary;
+
+	bool okay = (bool)file.read((char*)&header, sizeof(header)) && memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0 && header.length > 0;
+	if (okay) {
+		binary.resize(header.length);
+		okay = (bool)file.read(binary.data(), header.length);
+	}
+	file.close();
+
+	GLuint program = 0;
+	if (okay) {
+		program = glCreateProgram();
+		GLExtensions::programBinary(program, header.format, binary.data(), header.length);
+
+		GLint linked;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if (!linked) {
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+
+	// Corrupt, or the driver no longer accepts it (usually an update that kept the version string),
+	// either way it'll be replaced once the program has been compiled again
+	if (!program) {
+		cout << "Program binary " << filePath(key) << " was rejected, compiling from source" << endl;
+		remove(filePath(key).c_str());
+		rejectedCount++;
+	}
+
+	return program;
+}
+
+void ProgramBinaryCache::prepare(GLuint program) {
+	if (isAvailable() && GLExtensions::programParameteri)
+		GLExtensions::programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramBinaryCache::save(const string &key, GLuint program) {
+	if (!isAvailable())
+		return;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	BinaryHeader header;
+	memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	vector<char> binary(length);
+	GLsizei written = 0;
+	GLExtensions::getProgramBinary(program, length, &written, &header.format, binary.data());
+	if (written <= 0)
+		return;
+	header.length = written;
+
+	if (!directoryCreated) {
+		if (!FrameCapture::createDirectory(directory)) {
+			// Don't keep trying (and printing) for every program
+			enabled = false;
+			return;
+		}
+		directoryCreated = true;
+	}
+
+	ofstream file(filePath(key), ios::binary);
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), written);
+
+	if (!file) {
+		cout << "Couldn't write program binary " << filePath(key) << endl;
+		file.close();
+		remove(filePath(key).c_str());
+	}
+}
+
+void ProgramBinaryCache::recordBuild(bool fromCache, double ms) {
+	if (fromCache) {
+		loadedCount++;
+		loadMs += ms;
+	} else {
+		compiledCount++;
+		compileMs += ms;
+	}
+}
+
+void ProgramBinaryCache::printStats() {
+	cout << "Shader programs: " << loadedCount << " from cache in " << loadMs << " ms, "
+		<< compiledCount << " compiled in " << compileMs << " ms";
+
+	if (rejectedCount > 0)
+		cout << " (" << rejectedCount << " cached binaries rejected)";
+
+	if (!isAvailable())
+		cout << ", program binary cache " << (enabled ? "not supported by the driver" : "off");
+
+	cout << endl;
+}
+
+int ProgramBinaryCache::getLoadedCount() {
+
+	return loadedCount;
+}
+
+int ProgramBinaryCache::getCompiledCount() {
+
+	return compiledCount;
+}
@@ -0,0 +1,57 @@
+#ifndef PROGRAMBINARYCACHE_H
+#define PROGRAMBINARYCACHE_H
+
+#include "Includes.h"
+
+// Keeps linked programs on disk with glGetProgramBinary so later runs can skip compiling and linking.
+// A program's file is named by a hash of its shader sources, its defines and the driver's vendor,
+// renderer and version strings, so editing a shader or updating the driver just misses the cache
+// instead of loading a stale binary. Drivers can still reject a binary (glProgramBinary fails to
+// link), in which case the file is deleted and the caller compiles from source as usual.
+//
+// Only used when the driver supports program binaries (GL 4.1 or ARB_get_program_binary) with at
+// least one format, otherwise load() always misses and save() does nothing.
+class ProgramBinaryCache {
+	private:
+		static std::string				directory;
+		static bool						enabled;
+		static bool						directoryCreated;
+
+		// Startup report, loads and compiles from every ShaderVariants build
+		static int						loadedCount;
+		static int						compiledCount;
+		static int						rejectedCount;
+		static double					loadMs;
+		static double					compileMs;
+
+		static std::string				filePath(const std::string &key);
+
+	public:
+		// Where the binaries go (default "ShaderCache"), created when the first one is saved
+		static void setDirectory(const std::string &path);
+		static void setEnabled(bool newEnabled);
+
+		// False if turned off or the driver can't give out program binaries
+		static bool isAvailable();
+
+		// Hash of everything that affects the binary, as 16 hex digits
+		static std::string makeKey(const std::string &vertexSource, const std::string &fragmentSource, const std::string &defines);
+
+		// A linked program loaded from the cache, 0 if there's no usable binary for key
+		static GLuint load(const std::string &key);
+
+		// Call before linking a program that will be saved, some drivers need to be told up front
+		static void prepare(GLuint program);
+
+		// Writes a linked program's binary for the next run
+		static void save(const std::string &key, GLuint program);
+
+		// ShaderVariants reports how long each program took to build and where it came from
+		static void recordBuild(bool fromCache, double ms);
+
+		// "Shader programs: N from cache in X ms, M compiled in Y ms ..."
+		static void printStats();
+		static int getLoadedCount();
+		static int getCompiledCount();
+};
+#endif
@@ -0,0 +1,82 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+using namespace std;
+
+// Bits of the sort key given to each field, most significant first
+static const int PROGRAM_BITS = 16;
+static const int TEXTURE_BITS = 16;
+static const int WINDING_BITS = 1;
+static const int DEPTH_BITS = 24;
+
+RenderQueue::RenderQueue(float newMaxDepth) {
+	maxDepth = newMaxDepth;
+}
+
+uint64_t RenderQueue::makeKey(const DrawItem &item) {
+	float depth = min(max(item.depth / maxDepth, 0.0f), 1.0f);
+	uint64_t depthBits = (uint64_t)(depth * ((1 << DEPTH_BITS) - 1));
+	uint64_t winding = item.frontFace == GL_CW ? 1 : 0;
+
+	uint64_t key = item.program & ((1 << PROGRAM_BITS) - 1);
+	key = (key << TEXTURE_BITS) | (item.texture & ((1 << TEXTURE_BITS) - 1));
+	key = (key << WINDING_BITS) | winding;
+	key = (key << DEPTH_BITS) | depthBits;
+
+	return key;
+}
+
+void RenderQueue::submit(const DrawItem &item) {
+	QueuedDraw draw;
+	draw.key = makeKey(item);
+	draw.index = (int)items.size();
+
+	items.push_back(item);
+	order.push_back(draw);
+}
+
+GLStateCache* RenderQueue::getStateCache() {
+
+	return &stateCache;
+}
+
+void RenderQueue::execute() {
+	// Stable so draws with equal keys keep their submission order
+	stable_sort(order.begin(), order.end(), [](const QueuedDraw &a, const QueuedDraw &b) { return a.key < b.key; });
+
+	for (const QueuedDraw &draw : order) {
+		DrawItem &item = items[draw.index];
+
+		stateCache.useProgram(item.program);
+		stateCache.bindTexture(0, item.texture);
+		stateCache.setFrontFace(item.frontFace);
+
+		if (item.instancedMesh) {
+			item.instancedMesh->render();
+			continue;
+		}
+
+		glUniformMatrix4fv(item.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(*item.modelMatrix));
+		glUniformMatrix4fv(item.invTransposeMatrixLocation, 1, GL_FALSE, glm::value_ptr(*item.invTransposeMatrix));
+
+		if (item.conditionQuery)
+			glBeginConditionalRender(item.conditionQuery, GL_QUERY_NO_WAIT);
+
+		if (item.model)
+			item.model->render();
+		else if (item.sphere)
+			item.sphere->render();
+
+		if (item.conditionQuery)
+			glEndConditionalRender();
+	}
+
+	stateCache.setFrontFace(GL_CCW);
+	stateCache.useProgram(0);
+
+	// Whatever runs next can change state behind the cache's back
+	stateCache.invalidate();
+
+	items.clear();
+	order.clear();
+}
@@ -0,0 +1,68 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "Includes.h"
+#include "GLStateCache.h"
+#include "InstancedMesh.h"
+#include <cstdint>
+#include <vector>
+
+// Collects a frame's draws and executes them sorted by a 64 bit key made of
+// program | texture | winding | depth, so draws sharing state end up next to each other and the
+// state cache can skip the repeated binds. Within the same state, draws go front to back.
+class RenderQueue {
+	public:
+		// One draw, one of model, sphere or instancedMesh is set. The queue only sets the per-draw uniforms
+		// (none for instanced meshes, their transforms are per instance), anything that's the same for the
+		// whole frame is left to the caller.
+		struct DrawItem {
+			GLuint							program;
+			GLuint							texture;
+			GLenum							frontFace = GL_CCW;
+
+			Model							*model = nullptr;
+			Sphere							*sphere = nullptr;
+			InstancedMesh					*instancedMesh = nullptr;
+
+			// Must stay valid until execute(), normally they point into a TransformStore
+			const glm::mat4					*modelMatrix = nullptr;
+			const glm::mat4					*invTransposeMatrix = nullptr;
+			GLint							modelMatrixLocation = -1;
+			GLint							invTransposeMatrixLocation = -1;
+
+			// Distance from the camera, only used for ordering
+			float							depth = 0.0f;
+
+			// Non zero to only draw if this occlusion query passed (decided on the GPU, no waiting)
+			GLuint							conditionQuery = 0;
+		};
+
+	private:
+		struct QueuedDraw {
+			uint64_t						key;
+			int								index;
+		};
+
+		std::vector<DrawItem>			items;
+		std::vector<QueuedDraw>			order;
+
+		// Depths are quantised over 0 to maxDepth for the key
+		float							maxDepth;
+
+		GLStateCache					stateCache;
+
+		uint64_t						makeKey(const DrawItem &item);
+
+	public:
+		RenderQueue(float newMaxDepth = 100.0f);
+
+		void submit(const DrawItem &item);
+
+		// Cached state, for setting per-frame uniforms through the same cache before execute()
+		GLStateCache* getStateCache();
+
+		// Sorts and draws everything submitted since the last call, then empties the queue.
+		// Leaves program 0 bound and counter-clockwise winding, like the rest of the code expects.
+		void execute();
+};
+#endif
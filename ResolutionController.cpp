@@ -0,0 +1,48 @@
+#include "ResolutionController.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// Fraction of the way to the ideal scale moved per measurement
+static const float RESPONSE = 0.3f;
+
+// Changes smaller than this (relative) are ignored
+static const float DEAD_BAND = 0.05f;
+
+// Scales are rounded to a multiple of this so the viewport doesn't change every frame
+static const float SCALE_STEP = 0.05f;
+
+ResolutionController::ResolutionController(float newTargetMs, float newMinScale, float newMaxScale) {
+	targetMs = newTargetMs;
+	minScale = newMinScale;
+	maxScale = newMaxScale;
+	scale = newMinScale;
+}
+
+float ResolutionController::update(double gpuMs, int frame) {
+	if (frame <= lastFrame || gpuMs <= 0.0)
+		return scale;
+
+	lastFrame = frame;
+
+	float ideal = scale * sqrt((float)(targetMs / gpuMs));
+	ideal = min(max(ideal, minScale), maxScale);
+
+	if (fabs(ideal - scale) < scale * DEAD_BAND)
+		return scale;
+
+	float newScale = scale + (ideal - scale) * RESPONSE;
+	newScale = floor(newScale / SCALE_STEP + 0.5f) * SCALE_STEP;
+	scale = min(max(newScale, minScale), maxScale);
+
+	return scale;
+}
+
+float ResolutionController::getScale() {
+	return scale;
+}
+
+float ResolutionController::getTargetMs() {
+	return targetMs;
+}
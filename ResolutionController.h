@@ -0,0 +1,27 @@
+#ifndef RESOLUTIONCONTROLLER_H
+#define RESOLUTIONCONTROLLER_H
+
+// Picks the render scale (supersampling factor per axis, fractional) that keeps the measured GPU
+// time of the scene pass near a target. Shading cost goes with the number of pixels, so the
+// scale that would hit the target is scale * sqrt(target / measured). The controller moves part
+// of the way there each time and ignores small differences so the scale doesn't flicker.
+class ResolutionController {
+	private:
+		float							targetMs;
+		float							minScale;
+		float							maxScale;
+		float							scale;
+
+		// Measurements arrive a few frames late, don't use the same one twice
+		int								lastFrame = -1;
+
+	public:
+		ResolutionController(float newTargetMs, float newMinScale, float newMaxScale);
+
+		// Feed the GPU time of the scene pass and the frame it was measured in, returns the new scale
+		float update(double gpuMs, int frame);
+
+		float getScale();
+		float getTargetMs();
+};
+#endif
@@ -0,0 +1,125 @@
+#include "ResolveBenchmark.h"
+#include "Includes.h"
+#include "SSAAResolver.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const int WARMUP_RESOLVES = 3;
+static const int TIMED_RESOLVES = 20;
+
+struct BenchSize {
+	const char		*name;
+	int				width;
+	int				height;
+};
+
+static const BenchSize BENCH_SIZES[] = {
+	{ "1080p", 1920, 1080 },
+	{ "4K", 3840, 2160 },
+};
+
+static const int BENCH_FACTORS[] = { 2, 3, 4 };
+
+// GPU time of one resolve in ms, averaged over TIMED_RESOLVES
+static double timeResolve(SSAAResolver *resolver, GLuint sourceTexture, GLuint query) {
+	for (int i = 0; i < WARMUP_RESOLVES; i++)
+		resolver->resolve(sourceTexture);
+	glFinish();
+
+	glBeginQuery(GL_TIME_ELAPSED, query);
+	for (int i = 0; i < TIMED_RESOLVES; i++)
+		resolver->resolve(sourceTexture);
+	glEndQuery(GL_TIME_ELAPSED);
+
+	GLuint64 elapsed = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+
+	return elapsed / 1000000.0 / TIMED_RESOLVES;
+}
+
+bool runResolveBenchmark(const string &csvPath) {
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+	ofstream csv;
+	if (!csvPath.empty()) {
+		csv.open(csvPath);
+		if (!csv) {
+			cout << "Couldn't open " << csvPath << " for writing" << endl;
+			return false;
+		}
+		csv << "output,width,height,factor,filter,ms" << endl;
+	}
+
+	GLuint query;
+	glGenQueries(1, &query);
+
+	cout << "Resolve GPU time in ms, average of " << TIMED_RESOLVES << " resolves" << endl;
+	printf("%-6s %-6s", "output", "factor");
+	for (int f = 0; f < RESOLVE_FILTER_COUNT; f++)
+		printf(" %10s", resolveFilterName((ResolveFilter)f));
+	printf("\n");
+
+	bool measured = false;
+
+	for (const BenchSize &size : BENCH_SIZES) {
+		for (int factor : BENCH_FACTORS) {
+			int sourceWidth = size.width * factor;
+			int sourceHeight = size.height * factor;
+
+			if (sourceWidth > maxTextureSize || sourceHeight > maxTextureSize) {
+				printf("%-6s x%-5d skipped, %dx%d is over the %d texture size limit\n", size.name, factor,
+					sourceWidth, sourceHeight, maxTextureSize);
+				continue;
+			}
+
+			// Stand-in for the supersampled scene, cleared rather than rendered
+			GLuint sourceTexture, sourceFBO;
+			glGenTextures(1, &sourceTexture);
+			glBindTexture(GL_TEXTURE_2D, sourceTexture);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, sourceWidth, sourceHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			glGenFramebuffers(1, &sourceFBO);
+			glBindFramebuffer(GL_FRAMEBUFFER, sourceFBO);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sourceTexture, 0);
+
+			if (glGetError() != GL_NO_ERROR || glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+				printf("%-6s x%-5d skipped, couldn't allocate the %dx%d source\n", size.name, factor, sourceWidth, sourceHeight);
+			} else {
+				glViewport(0, 0, sourceWidth, sourceHeight);
+				glClearColor(0.3f, 0.5f, 0.7f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+
+				SSAAResolver resolver(size.width, size.height, factor);
+
+				printf("%-6s x%-5d", size.name, factor);
+				for (int f = 0; f < RESOLVE_FILTER_COUNT; f++) {
+					resolver.setFilter((ResolveFilter)f);
+					double ms = timeResolve(&resolver, sourceTexture, query);
+					printf(" %10.3f", ms);
+
+					if (csv)
+						csv << size.name << "," << size.width << "," << size.height << "," << factor << ","
+							<< resolveFilterName((ResolveFilter)f) << "," << ms << endl;
+				}
+				printf("\n");
+				fflush(stdout);
+
+				measured = true;
+			}
+
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glDeleteFramebuffers(1, &sourceFBO);
+			glDeleteTextures(1, &sourceTexture);
+		}
+	}
+
+	glDeleteQueries(1, &query);
+	return measured;
+}
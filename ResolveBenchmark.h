@@ -0,0 +1,12 @@
+#ifndef RESOLVEBENCHMARK_H
+#define RESOLVEBENCHMARK_H
+
+#include <string>
+
+// Times SSAAResolver::resolve() with every filter at 1920x1080 and 3840x2160 for factors 2, 3 and 4
+// and prints ms per resolve. The source is a cleared texture, the cost doesn't depend on the content.
+// Needs a current context. Results are also written to csvPath unless it's empty.
+// Returns false if nothing could be measured.
+bool runResolveBenchmark(const std::string &csvPath);
+
+#endif
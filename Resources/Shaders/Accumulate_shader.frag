@@ -0,0 +1,26 @@
+#version 330
+
+//
+// Adds one jittered render of the scene into the accumulation target.
+// Drawn with additive blending (GL_ONE, GL_ONE), the weights of all the passes add up to 1.
+// With a mask only the masked (or only the unmasked) pixels are written, the rest get 0.
+//
+uniform sampler2D texture0;
+uniform float weight;
+
+uniform sampler2D maskTexture;
+uniform int maskMode; // 0 no mask, 1 masked pixels only, 2 unmasked pixels only
+
+layout (location=0) out vec4 fragColour;
+
+void main(void) {
+	// Same resolution as the target, so read the matching texel directly
+	fragColour = texelFetch(texture0, ivec2(gl_FragCoord.xy), 0) * weight;
+
+	if (maskMode != 0) {
+		bool masked = texelFetch(maskTexture, ivec2(gl_FragCoord.xy), 0).r > 0.5;
+
+		if (masked != (maskMode == 1))
+			fragColour = vec4(0.0);
+	}
+}
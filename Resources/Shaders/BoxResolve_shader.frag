@@ -0,0 +1,45 @@
+#version 330
+
+//
+// One axis of a separable box filter downsample.
+// Each output pixel averages the 'samples' source texels it covers along 'direction'.
+// Texels are read in pairs with a single bilinear fetch placed exactly between them
+// (both get a weight of 0.5), so a pass costs samples / 2 fetches instead of samples.
+// The source texture must use GL_LINEAR filtering.
+//
+uniform sampler2D texture0;
+
+uniform int samples;
+uniform ivec2 direction; // (1, 0) for the horizontal pass, (0, 1) for the vertical pass
+uniform ivec2 outputOffset; // where the region being resolved starts in the target (tiled rendering)
+
+layout (location=0) out vec4 fragColour;
+
+void main(void) {
+	vec2 texelSize = 1.0 / vec2(textureSize(texture0, 0));
+
+	// Along the filter axis the output pixel covers source texels [first, first + samples)
+	vec2 outPos = floor(gl_FragCoord.xy) - vec2(outputOffset);
+	vec2 scale = vec2(1.0) + vec2(direction) * float(samples - 1);
+	vec2 first = outPos * scale;
+
+	// Across the filter axis sample the texel centre so no neighbouring row/column bleeds in
+	vec2 across = (first + vec2(0.5)) * vec2(1 - direction);
+
+	vec4 newColour = vec4(0.0);
+
+	int pairs = samples / 2;
+	for (int i = 0; i < pairs; i++) {
+		// The boundary between texels first + 2i and first + 2i + 1
+		vec2 pos = across + vec2(direction) * (first + vec2(float(2 * i + 1)));
+		newColour += texture(texture0, pos * texelSize) * 2.0;
+	}
+
+	// Odd factors have one texel left over
+	if (samples % 2 == 1) {
+		vec2 pos = across + vec2(direction) * (first + vec2(float(samples) - 0.5));
+		newColour += texture(texture0, pos * texelSize);
+	}
+
+	fragColour = newColour / float(samples);
+}
@@ -0,0 +1,53 @@
+#version 330
+
+//
+// Lighting pass of deferred shading, drawn as a fullscreen triangle (Resolve_shader.vert). The
+// surface is read back from the G-buffer written by GBuffer_shader.frag, then lit with the same
+// Lighting.glsl as Phong_shader.frag, so every pixel is shaded once whatever was drawn over it.
+// Takes NUM_OF_DIR_LIGHTS from ShaderVariants like Phong_shader.frag.
+//
+
+// G-buffer, read one texel per pixel
+uniform sampler2D albedoTexture;
+uniform sampler2D normalTexture;
+uniform sampler2D depthTexture;
+
+// Inverse of the view-projection the G-buffer was drawn with, over a viewport of viewportSize
+uniform mat4 inverseViewProjection;
+uniform vec2 viewportSize;
+
+// The surface being lit, filled in from the G-buffer under the names Lighting.glsl uses
+vec4 posWorldCoord;
+vec3 normalWorldCoord;
+vec4 texColour;
+
+// Written with a no specular variant of the G-buffer shader, so specular is skipped like NO_SPECULAR does
+bool surfaceSpecular;
+#define SURFACE_SPECULAR surfaceSpecular
+
+#include "Lighting.glsl"
+
+layout (location = 0) out vec4 fragColour;
+
+void main(void) {
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+	vec4 normal = texelFetch(normalTexture, pixel, 0);
+
+	// Nothing was drawn here, leave it cleared like the forward path does
+	if (normal.a == 0.0)
+		discard;
+
+	normalWorldCoord = normal.xyz * 2.0 - 1.0;
+	surfaceSpecular = normal.a > 0.5;
+	texColour = vec4(texelFetch(albedoTexture, pixel, 0).rgb, 1.0);
+
+	vec3 ndc = vec3(gl_FragCoord.xy / viewportSize, texelFetch(depthTexture, pixel, 0).r) * 2.0 - 1.0;
+	posWorldCoord = inverseViewProjection * vec4(ndc, 1.0);
+	posWorldCoord /= posWorldCoord.w;
+
+	vec3 result = lightSurface();
+
+    vec3 P = vec3(1.0 / 0.8);
+    fragColour = vec4(pow(result, P), 1.0);
+}
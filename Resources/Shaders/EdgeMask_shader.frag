@@ -0,0 +1,57 @@
+#version 330
+
+//
+// Marks the pixels of a 1x render that need supersampling: luminance edges in the colour and
+// geometric edges (depth discontinuities) in the depth buffer. Writes 1 for an edge, 0 otherwise.
+//
+uniform sampler2D colourTexture;
+uniform sampler2D depthTexture;
+
+uniform float nearPlane;
+uniform float farPlane;
+
+// Smallest luminance contrast in the neighbourhood that counts as an edge
+uniform float lumaThreshold;
+
+// Smallest relative change in view depth between neighbours that counts as an edge
+uniform float depthThreshold;
+
+layout (location=0) out vec4 mask;
+
+float luma(ivec2 pixel) {
+	return dot(texelFetch(colourTexture, pixel, 0).rgb, vec3(0.299, 0.587, 0.114));
+}
+
+// The depth buffer is non-linear, compare distances from the camera instead
+float viewDepth(ivec2 pixel) {
+	float z = texelFetch(depthTexture, pixel, 0).r * 2.0 - 1.0;
+	return 2.0 * nearPlane * farPlane / (farPlane + nearPlane - z * (farPlane - nearPlane));
+}
+
+void main(void) {
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	ivec2 maxPixel = textureSize(colourTexture, 0) - ivec2(1);
+
+	ivec2 offsets[4] = ivec2[4](ivec2(-1, 0), ivec2(1, 0), ivec2(0, -1), ivec2(0, 1));
+
+	float centreLuma = luma(pixel);
+	float centreDepth = viewDepth(pixel);
+
+	float minLuma = centreLuma;
+	float maxLuma = centreLuma;
+	float maxDepthChange = 0.0;
+
+	for (int i = 0; i < 4; i++) {
+		ivec2 neighbour = clamp(pixel + offsets[i], ivec2(0), maxPixel);
+
+		float l = luma(neighbour);
+		minLuma = min(minLuma, l);
+		maxLuma = max(maxLuma, l);
+
+		float d = viewDepth(neighbour);
+		maxDepthChange = max(maxDepthChange, abs(d - centreDepth) / min(d, centreDepth));
+	}
+
+	bool edge = maxLuma - minLuma > lumaThreshold || maxDepthChange > depthThreshold;
+	mask = vec4(edge ? 1.0 : 0.0);
+}
@@ -0,0 +1,151 @@
+#version 330
+
+//
+// Fast approximate anti-aliasing on the 1x scene colour.
+// Finds the local contrast from luma, decides whether the edge through the pixel is horizontal or
+// vertical, walks along it in both directions to find where it ends, and then samples across the
+// edge by an amount that depends on how far the pixel is from the nearer end. A separate sub-pixel
+// term softens single pixel details that the edge walk can't see.
+//
+uniform sampler2D texture0;
+
+// Below this local contrast (relative to the brightest neighbour) a pixel is left alone
+const float EDGE_THRESHOLD = 0.125;
+
+// Absolute minimum contrast so dark areas aren't filtered for noise
+const float EDGE_THRESHOLD_MIN = 0.0312;
+
+// Amount of sub-pixel aliasing removal, 0 off, 1 softest
+const float SUBPIXEL_QUALITY = 0.75;
+
+const int SEARCH_STEPS = 12;
+const float searchStep[12] = float[12](1.0, 1.0, 1.0, 1.0, 1.0, 1.5, 2.0, 2.0, 2.0, 2.0, 4.0, 8.0);
+
+layout (location=0) out vec4 fragColour;
+
+float luma(vec3 colour) {
+	return dot(colour, vec3(0.299, 0.587, 0.114));
+}
+
+vec3 sampleColour(vec2 uv) {
+	return textureLod(texture0, uv, 0.0).rgb;
+}
+
+float sampleLuma(vec2 uv) {
+	return luma(sampleColour(uv));
+}
+
+void main(void) {
+	vec2 texelSize = 1.0 / vec2(textureSize(texture0, 0));
+	vec2 uv = gl_FragCoord.xy * texelSize;
+
+	vec4 centreColour = textureLod(texture0, uv, 0.0);
+	float lumaCentre = luma(centreColour.rgb);
+
+	float lumaDown = sampleLuma(uv + vec2(0.0, -texelSize.y));
+	float lumaUp = sampleLuma(uv + vec2(0.0, texelSize.y));
+	float lumaLeft = sampleLuma(uv + vec2(-texelSize.x, 0.0));
+	float lumaRight = sampleLuma(uv + vec2(texelSize.x, 0.0));
+
+	float lumaMin = min(lumaCentre, min(min(lumaDown, lumaUp), min(lumaLeft, lumaRight)));
+	float lumaMax = max(lumaCentre, max(max(lumaDown, lumaUp), max(lumaLeft, lumaRight)));
+	float lumaRange = lumaMax - lumaMin;
+
+	if (lumaRange < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD)) {
+		fragColour = centreColour;
+		return;
+	}
+
+	float lumaDownLeft = sampleLuma(uv + vec2(-texelSize.x, -texelSize.y));
+	float lumaUpRight = sampleLuma(uv + vec2(texelSize.x, texelSize.y));
+	float lumaUpLeft = sampleLuma(uv + vec2(-texelSize.x, texelSize.y));
+	float lumaDownRight = sampleLuma(uv + vec2(texelSize.x, -texelSize.y));
+
+	float lumaDownUp = lumaDown + lumaUp;
+	float lumaLeftRight = lumaLeft + lumaRight;
+	float lumaLeftCorners = lumaDownLeft + lumaUpLeft;
+	float lumaDownCorners = lumaDownLeft + lumaDownRight;
+	float lumaRightCorners = lumaDownRight + lumaUpRight;
+	float lumaUpCorners = lumaUpRight + lumaUpLeft;
+
+	// Second derivatives along each axis decide the edge orientation
+	float edgeHorizontal = abs(-2.0 * lumaLeft + lumaLeftCorners) + abs(-2.0 * lumaCentre + lumaDownUp) * 2.0 + abs(-2.0 * lumaRight + lumaRightCorners);
+	float edgeVertical = abs(-2.0 * lumaUp + lumaUpCorners) + abs(-2.0 * lumaCentre + lumaLeftRight) * 2.0 + abs(-2.0 * lumaDown + lumaDownCorners);
+	bool isHorizontal = edgeHorizontal >= edgeVertical;
+
+	// Which side of the pixel the edge is on
+	float luma1 = isHorizontal ? lumaDown : lumaLeft;
+	float luma2 = isHorizontal ? lumaUp : lumaRight;
+	float gradient1 = luma1 - lumaCentre;
+	float gradient2 = luma2 - lumaCentre;
+	bool steepest1 = abs(gradient1) >= abs(gradient2);
+	float gradientScaled = 0.25 * max(abs(gradient1), abs(gradient2));
+
+	float stepLength = isHorizontal ? texelSize.y : texelSize.x;
+	float lumaLocalAverage;
+
+	if (steepest1) {
+		stepLength = -stepLength;
+		lumaLocalAverage = 0.5 * (luma1 + lumaCentre);
+	} else {
+		lumaLocalAverage = 0.5 * (luma2 + lumaCentre);
+	}
+
+	// Start on the edge itself, half a pixel towards the steeper side
+	vec2 edgeUV = uv;
+	if (isHorizontal)
+		edgeUV.y += stepLength * 0.5;
+	else
+		edgeUV.x += stepLength * 0.5;
+
+	vec2 offset = isHorizontal ? vec2(texelSize.x, 0.0) : vec2(0.0, texelSize.y);
+	vec2 uv1 = edgeUV - offset;
+	vec2 uv2 = edgeUV + offset;
+
+	float lumaEnd1 = sampleLuma(uv1) - lumaLocalAverage;
+	float lumaEnd2 = sampleLuma(uv2) - lumaLocalAverage;
+	bool reached1 = abs(lumaEnd1) >= gradientScaled;
+	bool reached2 = abs(lumaEnd2) >= gradientScaled;
+
+	// Walk along the edge in both directions until the luma changes enough to be the end of it
+	for (int i = 1; i < SEARCH_STEPS && !(reached1 && reached2); i++) {
+		if (!reached1) {
+			uv1 -= offset * searchStep[i];
+			lumaEnd1 = sampleLuma(uv1) - lumaLocalAverage;
+			reached1 = abs(lumaEnd1) >= gradientScaled;
+		}
+
+		if (!reached2) {
+			uv2 += offset * searchStep[i];
+			lumaEnd2 = sampleLuma(uv2) - lumaLocalAverage;
+			reached2 = abs(lumaEnd2) >= gradientScaled;
+		}
+	}
+
+	float distance1 = isHorizontal ? (uv.x - uv1.x) : (uv.y - uv1.y);
+	float distance2 = isHorizontal ? (uv2.x - uv.x) : (uv2.y - uv.y);
+	bool direction1 = distance1 < distance2;
+	float distanceFinal = min(distance1, distance2);
+	float edgeLength = distance1 + distance2;
+
+	// Only move across the edge if the nearer end agrees with which side the pixel is on
+	bool lumaCentreSmaller = lumaCentre < lumaLocalAverage;
+	bool correctVariation = ((direction1 ? lumaEnd1 : lumaEnd2) < 0.0) != lumaCentreSmaller;
+	float pixelOffset = correctVariation ? -distanceFinal / edgeLength + 0.5 : 0.0;
+
+	// Sub-pixel aliasing from the full 3x3 average
+	float lumaAverage = (1.0 / 12.0) * (2.0 * (lumaDownUp + lumaLeftRight) + lumaLeftCorners + lumaRightCorners);
+	float subPixelOffset1 = clamp(abs(lumaAverage - lumaCentre) / lumaRange, 0.0, 1.0);
+	float subPixelOffset2 = (-2.0 * subPixelOffset1 + 3.0) * subPixelOffset1 * subPixelOffset1;
+	float subPixelOffset = subPixelOffset2 * subPixelOffset2 * SUBPIXEL_QUALITY;
+
+	pixelOffset = max(pixelOffset, subPixelOffset);
+
+	vec2 finalUV = uv;
+	if (isHorizontal)
+		finalUV.y += pixelOffset * stepLength;
+	else
+		finalUV.x += pixelOffset * stepLength;
+
+	fragColour = vec4(sampleColour(finalUV), centreColour.a);
+}
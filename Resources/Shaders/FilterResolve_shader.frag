@@ -0,0 +1,42 @@
+#version 330
+
+//
+// One axis of a separable downsample with a higher quality reconstruction filter than the box
+// (Mitchell, Lanczos or Gaussian). With an integer factor every output pixel lines up with the
+// source texels the same way, so the weights are worked out once on the CPU and passed in.
+// Weights can be negative, so the intermediate target has to be a float format.
+//
+const int MAX_TAPS = 128;
+
+uniform sampler2D texture0;
+
+uniform int samples;
+uniform ivec2 direction; // (1, 0) for the horizontal pass, (0, 1) for the vertical pass
+
+// Source texel of the first tap relative to the first texel under the output pixel
+uniform int firstTap;
+uniform int tapCount;
+uniform float weights[MAX_TAPS];
+
+layout (location=0) out vec4 fragColour;
+
+void main(void) {
+	ivec2 outPos = ivec2(gl_FragCoord.xy);
+	ivec2 sourceSize = textureSize(texture0, 0);
+
+	bool horizontal = direction.x == 1;
+	int base = (horizontal ? outPos.x : outPos.y) * samples + firstTap;
+	int maxCoord = (horizontal ? sourceSize.x : sourceSize.y) - 1;
+
+	vec4 newColour = vec4(0.0);
+
+	for (int i = 0; i < tapCount; i++) {
+		// Taps past the image edge repeat the edge texel
+		int coord = clamp(base + i, 0, maxCoord);
+		ivec2 pos = horizontal ? ivec2(coord, outPos.y) : ivec2(outPos.x, coord);
+
+		newColour += texelFetch(texture0, pos, 0) * weights[i];
+	}
+
+	fragColour = newColour;
+}
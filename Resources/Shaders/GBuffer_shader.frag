@@ -0,0 +1,39 @@
+#version 330
+
+//
+// Writes the surface attributes the deferred lighting pass needs (see DeferredLighting_shader.frag).
+// Used with Phong_shader.vert and PhongInstanced_shader.vert, nothing is lit here. Takes the same
+// UNTEXTURED and NO_SPECULAR defines as Phong_shader.frag.
+//
+uniform sampler2D texture0;
+
+in vec4 posWorldCoord;
+in vec4 colour;
+in vec3 normalWorldCoord;
+in vec2 texCoord;
+
+// Albedo has 1 in alpha where something was drawn, the clear leaves 0. Normal's 2 bit alpha is 0 where
+// nothing was drawn, 1 / 3 for surfaces without specular and 1 for the rest.
+layout (location = 0) out vec4 albedo;
+layout (location = 1) out vec4 normal;
+layout (location = 2) out float depth;
+
+void main(void) {
+#ifdef UNTEXTURED
+	albedo = vec4(1.0);
+#else
+	albedo = vec4(texture(texture0, texCoord).rgb, 1.0);
+#endif
+
+#ifdef NO_SPECULAR
+	float specular = 1.0 / 3.0;
+#else
+	float specular = 1.0;
+#endif
+
+	// World space, packed into 0 to 1 for the unsigned normalized target
+	normal = vec4(normalize(normalWorldCoord) * 0.5 + 0.5, specular);
+
+	// Window depth, the world position is rebuilt from it with the inverse view-projection
+	depth = gl_FragCoord.z;
+}
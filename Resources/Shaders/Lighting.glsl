@@ -0,0 +1,179 @@
+//
+// Phong lighting shared by Phong_shader.frag (forward) and DeferredLighting_shader.frag, pulled in with
+// #include by ShaderVariants. The including shader declares the surface first:
+//  vec4 posWorldCoord     world position
+//  vec3 normalWorldCoord  world normal, doesn't need to be unit length
+//  vec4 texColour         surface colour
+// and can define SURFACE_SPECULAR as a bool expression to turn specular off per pixel (the deferred
+// pass reads it from the G-buffer). NO_SPECULAR leaves specular out at compile time.
+//
+#ifndef NUM_OF_DIR_LIGHTS
+#define NUM_OF_DIR_LIGHTS 1
+#endif
+
+#ifndef SURFACE_SPECULAR
+#define SURFACE_SPECULAR true
+#endif
+
+// Both structs are 80 bytes and are mirrored by the light structs in HouseScene.h, so field order
+// matters (the point light's exponent fills the 4th component after the attenuation). Directional
+// lights are in the std140 Lights block, point lights are 5 texels each of the pointLights buffer.
+struct DirLight {
+    vec4 lightDirection; // direction light comes FROM (specified in World Coordinates)
+	vec4 lightDiffuseColour;
+	vec4 lightSpecularColour;
+	vec4 lightAmbientColour;
+	float lightSpecularExponent;
+};
+
+struct PointLight {
+    vec4 lightPosition; // direction light comes FROM (specified in World Coordinates)
+	vec4 lightDiffuseColour;
+	vec4 lightSpecularColour;
+	vec4 lightAmbientColour;
+	vec3 lightAttenuation;
+	float lightSpecularExponent;
+};
+
+layout (std140) uniform Lights {
+	DirLight dirLight[NUM_OF_DIR_LIGHTS];
+};
+
+// Point lights are clustered (see LightClusterer.h): clusters holds an offset into lightIndices and
+// a count for each cluster, and only those lights are evaluated for the fragment
+layout (std140) uniform Clusters {
+	ivec4 clusterCounts;
+	vec4 clusterScale; // xy: clusters per pixel, zw: slice = log(view depth) * z + w
+	vec4 clusterOffset; // xy: cluster at pixel 0, undoes the jitter or tile offset
+	vec4 viewDepthRow; // view depth = -dot(viewDepthRow, world position)
+};
+
+uniform samplerBuffer pointLights;
+uniform usamplerBuffer clusters;
+uniform usamplerBuffer lightIndices;
+
+uniform vec3 cameraPos; // to calculate specular lighting in world coordinate space, we need the location of the camera since the specular light
+    // term is viewer dependent
+
+PointLight fetchPointLight(int index) {
+	PointLight light;
+	light.lightPosition = texelFetch(pointLights, index * 5);
+	light.lightDiffuseColour = texelFetch(pointLights, index * 5 + 1);
+	light.lightSpecularColour = texelFetch(pointLights, index * 5 + 2);
+	light.lightAmbientColour = texelFetch(pointLights, index * 5 + 3);
+
+	vec4 attenuation = texelFetch(pointLights, index * 5 + 4);
+	light.lightAttenuation = attenuation.xyz;
+	light.lightSpecularExponent = attenuation.w;
+
+	return light;
+}
+
+vec3 calcDirLight(DirLight light) {
+	// make sure light direction vector is unit length (store in L)
+	vec4 L = normalize(light.lightDirection);
+    
+	// important to normalise length of normal otherwise shading artefacts occur
+	vec3 N = normalize(normalWorldCoord);
+	
+    // calculate lambertian term
+    float lambertian = clamp(dot(L.xyz, N), 0.0, 1.0);
+
+    //
+	// calculate diffuse light colour
+    vec3 diffuseColour = texColour.rgb * light.lightDiffuseColour.rgb * lambertian; // input colour actually diffuse colour
+    //
+
+    vec3 amibentColour = texColour.rgb * light.lightAmbientColour.rgb;
+
+    vec3 specularColour = vec3(0.0);
+#ifndef NO_SPECULAR
+    if (SURFACE_SPECULAR) {
+        // vectors needed for specular light calculation...
+        vec3 E = cameraPos - posWorldCoord.xyz; // vector from point on object surface in world coords to camera
+        E = normalize(E);
+        vec3 R = reflect(-L.xyz, N); // reflected light vector about normal N
+
+        float specularIntensity = pow(max(dot(R, E), 0.0), light.lightSpecularExponent);
+        specularColour = vec3(1.0f, 1.0f, 1.0f) * light.lightSpecularColour.rgb * specularIntensity * lambertian;
+    }
+#endif
+
+	//
+    // combine colour components to get final pixel / fragment colour
+    //
+    vec3 rgbColour = amibentColour + diffuseColour + specularColour;
+
+	return rgbColour;
+}
+
+vec3 calcPointLight(PointLight light) {
+	// make sure light direction vector is unit length (store in L)
+	vec4 L = normalize(light.lightPosition - posWorldCoord);
+    
+	// important to normalise length of normal otherwise shading artefacts occur
+	vec3 N = normalize(normalWorldCoord);
+	
+    // calculate lambertian term
+    float lambertian = clamp(dot(L.xyz, N), 0.0, 1.0);
+
+    //
+	// calculate diffuse light colour
+    vec3 diffuseColour = texColour.rgb * light.lightDiffuseColour.rgb * lambertian; // input colour actually diffuse colour
+    //
+
+    //
+    // calculate specular light colour
+    //
+
+    vec3 specularColour = vec3(0.0);
+#ifndef NO_SPECULAR
+    if (SURFACE_SPECULAR) {
+        // vectors needed for specular light calculation...
+        vec3 E = cameraPos - posWorldCoord.xyz; // vector from point on object surface in world coords to camera
+        E = normalize(E);
+        vec3 R = reflect(-L.xyz, N); // reflected light vector about normal N
+
+        float specularIntensity = pow(max(dot(R, E), 0.0), light.lightSpecularExponent);
+        specularColour = texColour.rgb * vec3(1.0f, 1.0f, 1.0f) * light.lightSpecularColour.rgb * specularIntensity * lambertian;
+    }
+#endif
+
+	vec3 amibentColour = texColour.rgb * light.lightAmbientColour.rgb;
+
+	// attenuation
+    float dist = length(light.lightPosition - posWorldCoord);
+    float attenuation = 1.0f / (light.lightAttenuation.x + light.lightAttenuation.y * dist + light.lightAttenuation.z * (dist * dist));
+
+	//
+    // combine colour components to get final pixel / fragment colour
+    //
+	amibentColour *= attenuation;
+    specularColour *= attenuation;
+	diffuseColour *= attenuation;
+
+	vec3 rgbColour = amibentColour + diffuseColour + specularColour;
+
+	return rgbColour;
+}
+
+// Every light's contribution to the surface: the directional lights, then the point lights in the
+// cluster the fragment is in
+vec3 lightSurface() {
+	vec3 result = vec3(0.0);
+
+	// add the directional light's contribution to the output
+	for(int i = 0; i < NUM_OF_DIR_LIGHTS; i++)
+		result += calcDirLight(dirLight[i]);
+
+	// find the cluster this fragment is in and add its lights
+	float viewDepth = -dot(viewDepthRow, vec4(posWorldCoord.xyz, 1.0));
+	ivec3 cluster = ivec3(ivec2(floor(gl_FragCoord.xy * clusterScale.xy + clusterOffset.xy)), int(log(viewDepth) * clusterScale.z + clusterScale.w));
+	cluster = clamp(cluster, ivec3(0), clusterCounts.xyz - 1);
+
+	uvec2 lightList = texelFetch(clusters, (cluster.z * clusterCounts.y + cluster.y) * clusterCounts.x + cluster.x).xy;
+	for(uint i = 0u; i < lightList.y; i++)
+		result += calcPointLight(fetchPointLight(int(texelFetch(lightIndices, int(lightList.x + i)).r)));
+
+	return result;
+}
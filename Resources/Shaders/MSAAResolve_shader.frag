@@ -0,0 +1,22 @@
+#version 330
+
+//
+// Resolves a multisampled colour texture by averaging every sample of the pixel.
+// Does the same as glBlitFramebuffer, but is kept as a shader so the resolve can be
+// timed and changed (e.g. weighted or tonemapped) like the SSAA resolve.
+//
+uniform sampler2DMS texture0;
+
+uniform int samples;
+
+layout (location=0) out vec4 fragColour;
+
+void main(void) {
+	ivec2 pos = ivec2(gl_FragCoord.xy);
+
+	vec4 newColour = vec4(0.0);
+	for (int i = 0; i < samples; i++)
+		newColour += texelFetch(texture0, pos, i);
+
+	fragColour = newColour / float(samples);
+}
@@ -0,0 +1,10 @@
+#version 330
+
+//
+// Colour writes are masked off while the proxies are drawn, only the samples passing the depth test matter
+//
+layout (location = 0) out vec4 fragColour;
+
+void main(void) {
+	fragColour = vec4(1.0);
+}
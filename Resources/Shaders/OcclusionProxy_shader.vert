@@ -0,0 +1,16 @@
+#version 330
+
+//
+// Bounding box proxy for occlusion queries. The cube from VertexData.h (-1 to 1) is stretched
+// over the box given in world coordinates.
+//
+uniform mat4 viewProjectionMatrix;
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+
+layout (location = 0) in vec4 vertexPos;
+
+void main(void) {
+	vec3 worldPos = mix(boxMin, boxMax, vertexPos.xyz * 0.5 + 0.5);
+	gl_Position = viewProjectionMatrix * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,43 @@
+//
+// Phong_shader.vert for instanced draws: the model matrix and its inverse transpose are
+// per-instance attributes instead of uniforms. Use with Phong_shader.frag.
+//
+
+
+#version 330
+
+uniform mat4 viewProjectionMatrix; // to calc clip coords once lighting done in world space
+
+
+//
+// input vertex packet
+//
+
+layout (location = 0) in vec4 vertexPos;
+layout (location = 1) in vec3 vertexNormal;
+layout (location = 2) in vec2 vertexTexCoord;
+
+// per-instance transforms, each mat4 takes 4 attribute locations (6-9 and 10-13)
+layout (location = 6) in mat4 modelMatrix;
+layout (location = 10) in mat4 invTransposeModelMatrix;
+
+//
+// output vertex packet
+//
+out vec4 posWorldCoord;
+out vec4 colour;
+out vec3 normalWorldCoord;
+out vec2 texCoord;
+
+void main(void) {
+
+	// vertex position in world coords - for fragment shader
+	posWorldCoord = modelMatrix * vertexPos;
+
+	normalWorldCoord = (invTransposeModelMatrix * vec4(vertexNormal, 0.0)).xyz; // normal transformed to world coordinate space
+
+	texCoord = vertexTexCoord;
+
+	// vertex position in clip coords - necessary for pipeline
+	gl_Position = viewProjectionMatrix * posWorldCoord;
+}
@@ -0,0 +1,15 @@
+#version 330
+
+//
+// Fullscreen triangle generated from the vertex index, so resolve passes don't need a vertex buffer.
+// Draw with glDrawArrays(GL_TRIANGLES, 0, 3) and an empty VAO bound.
+//
+out vec2 texCoord;
+
+void main(void)
+{
+	vec2 pos = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+
+	texCoord = pos;
+	gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
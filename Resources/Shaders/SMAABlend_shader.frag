@@ -0,0 +1,45 @@
+#version 330
+
+//
+// Morphological AA, pass 3 of 3: neighbourhood blending.
+// Collects the weights of the four edges around the pixel (its own bottom and left edges, and the
+// bottom edge of the pixel above and left edge of the pixel to the right) and mixes in the
+// neighbours across them.
+//
+uniform sampler2D texture0;
+uniform sampler2D weightsTexture;
+
+layout (location=0) out vec4 fragColour;
+
+void main(void) {
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	ivec2 maxPixel = textureSize(texture0, 0) - ivec2(1);
+
+	vec2 own = texelFetch(weightsTexture, pixel, 0).rg;
+	float above = texelFetch(weightsTexture, min(pixel + ivec2(0, 1), maxPixel), 0).r;
+	float right = texelFetch(weightsTexture, min(pixel + ivec2(1, 0), maxPixel), 0).g;
+
+	// Positive weights on this pixel's edges pull from across them, negative ones on the
+	// neighbours' edges mean the neighbour's shape reaches into this pixel
+	float wDown = max(own.r, 0.0);
+	float wLeft = max(own.g, 0.0);
+	float wUp = pixel.y < maxPixel.y ? max(-above, 0.0) : 0.0;
+	float wRight = pixel.x < maxPixel.x ? max(-right, 0.0) : 0.0;
+
+	vec4 centre = texelFetch(texture0, pixel, 0);
+	float total = wDown + wLeft + wUp + wRight;
+
+	if (total == 0.0) {
+		fragColour = centre;
+		return;
+	}
+
+	vec4 blended = texelFetch(texture0, max(pixel + ivec2(0, -1), ivec2(0)), 0) * wDown
+		+ texelFetch(texture0, max(pixel + ivec2(-1, 0), ivec2(0)), 0) * wLeft
+		+ texelFetch(texture0, min(pixel + ivec2(0, 1), maxPixel), 0) * wUp
+		+ texelFetch(texture0, min(pixel + ivec2(1, 0), maxPixel), 0) * wRight;
+
+	// Never blend in more than the whole pixel
+	float scale = total > 1.0 ? 1.0 / total : 1.0;
+	fragColour = centre * (1.0 - total * scale) + blended * scale;
+}
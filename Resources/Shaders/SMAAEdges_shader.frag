@@ -0,0 +1,42 @@
+#version 330
+
+//
+// Morphological AA, pass 1 of 3: luma edge detection.
+// r is set when the pixel differs from its left neighbour, g when it differs from the one below.
+// A neighbour only counts if its contrast isn't much smaller than the strongest contrast around
+// the pixel, which stops soft gradients next to a hard edge being picked up as edges too.
+//
+uniform sampler2D texture0;
+
+const float THRESHOLD = 0.1;
+const float LOCAL_CONTRAST_FACTOR = 2.0;
+
+layout (location=0) out vec4 edges;
+
+float luma(ivec2 pixel) {
+	ivec2 maxPixel = textureSize(texture0, 0) - ivec2(1);
+	return dot(texelFetch(texture0, clamp(pixel, ivec2(0), maxPixel), 0).rgb, vec3(0.299, 0.587, 0.114));
+}
+
+void main(void) {
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+	float centre = luma(pixel);
+	float deltaLeft = abs(centre - luma(pixel + ivec2(-1, 0)));
+	float deltaDown = abs(centre - luma(pixel + ivec2(0, -1)));
+
+	vec2 edge = step(vec2(THRESHOLD), vec2(deltaLeft, deltaDown));
+
+	if (dot(edge, vec2(1.0)) == 0.0)
+		discard;
+
+	float deltaRight = abs(centre - luma(pixel + ivec2(1, 0)));
+	float deltaUp = abs(centre - luma(pixel + ivec2(0, 1)));
+	float deltaLeftLeft = abs(luma(pixel + ivec2(-1, 0)) - luma(pixel + ivec2(-2, 0)));
+	float deltaDownDown = abs(luma(pixel + ivec2(0, -1)) - luma(pixel + ivec2(0, -2)));
+
+	float maxDelta = max(max(max(deltaLeft, deltaDown), max(deltaRight, deltaUp)), max(deltaLeftLeft, deltaDownDown));
+	edge *= step(maxDelta, LOCAL_CONTRAST_FACTOR * vec2(deltaLeft, deltaDown));
+
+	edges = vec4(edge, 0.0, 0.0);
+}
@@ -0,0 +1,98 @@
+#version 330
+
+//
+// Morphological AA, pass 2 of 3: blending weights.
+// For the edge below the pixel (and the one to its left) the edge line is followed in both
+// directions to its ends, and the crossing edges at each end give the shape of the original
+// boundary (L, Z or U). The boundary is rebuilt as a line through the middle of the steps and the
+// area it cuts out of this pixel is how much the neighbour across the edge gets blended in.
+// Areas are computed directly instead of from SMAA's precomputed area texture.
+//
+// Output is signed: r for the edge below, positive means this pixel takes colour from the pixel
+// below, negative means the pixel below takes it from this one. g is the same for the left edge.
+//
+uniform sampler2D edgesTexture;
+
+const int MAX_SEARCH = 16;
+
+layout (location=0) out vec4 weights;
+
+vec2 edgesAt(ivec2 pixel) {
+	ivec2 maxPixel = textureSize(edgesTexture, 0) - ivec2(1);
+	if (any(lessThan(pixel, ivec2(0))) || any(greaterThan(pixel, maxPixel)))
+		return vec2(0.0);
+
+	return texelFetch(edgesTexture, pixel, 0).rg;
+}
+
+// Which way the boundary steps at an end of the edge line: +0.5 towards this pixel's side, -0.5
+// towards the other side, 0 for no step (or both, which can't be resolved)
+float stepHeight(bool positive, bool negative) {
+	if (positive == negative)
+		return 0.0;
+
+	return positive ? 0.5 : -0.5;
+}
+
+// Area between the rebuilt boundary and the edge line over the pixel starting at 'start'
+// along an edge line of 'len' pixels, with step heights h1 and h2 at its ends
+float area(float start, float len, float h1, float h2) {
+	float centre = start + 0.5;
+
+	// U shapes bend back to the edge line in the middle, L and Z shapes are one straight line
+	if (h1 == h2) {
+		if (h1 == 0.0)
+			return 0.0;
+
+		float halfLen = len * 0.5;
+		return centre < halfLen ? h1 * (1.0 - centre / halfLen) : h2 * (centre - halfLen) / halfLen;
+	}
+
+	return mix(h1, h2, centre / len);
+}
+
+void main(void) {
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	vec2 edge = edgesAt(pixel);
+
+	weights = vec4(0.0);
+
+	// Horizontal edge line between this row and the one below
+	if (edge.g > 0.0) {
+		int left = 0;
+		while (left < MAX_SEARCH && edgesAt(pixel + ivec2(-left - 1, 0)).g > 0.0)
+			left++;
+
+		int right = 0;
+		while (right < MAX_SEARCH && edgesAt(pixel + ivec2(right + 1, 0)).g > 0.0)
+			right++;
+
+		// Crossing edges are the vertical edges just past each end, in this row or the one below
+		ivec2 leftEnd = pixel + ivec2(-left, 0);
+		ivec2 rightEnd = pixel + ivec2(right + 1, 0);
+
+		float h1 = left < MAX_SEARCH ? stepHeight(edgesAt(leftEnd).r > 0.0, edgesAt(leftEnd + ivec2(0, -1)).r > 0.0) : 0.0;
+		float h2 = right < MAX_SEARCH ? stepHeight(edgesAt(rightEnd).r > 0.0, edgesAt(rightEnd + ivec2(0, -1)).r > 0.0) : 0.0;
+
+		weights.r = area(float(left), float(left + right + 1), h1, h2);
+	}
+
+	// Vertical edge line between this column and the one to the left
+	if (edge.r > 0.0) {
+		int down = 0;
+		while (down < MAX_SEARCH && edgesAt(pixel + ivec2(0, -down - 1)).r > 0.0)
+			down++;
+
+		int up = 0;
+		while (up < MAX_SEARCH && edgesAt(pixel + ivec2(0, up + 1)).r > 0.0)
+			up++;
+
+		ivec2 bottomEnd = pixel + ivec2(0, -down);
+		ivec2 topEnd = pixel + ivec2(0, up + 1);
+
+		float h1 = down < MAX_SEARCH ? stepHeight(edgesAt(bottomEnd).g > 0.0, edgesAt(bottomEnd + ivec2(-1, 0)).g > 0.0) : 0.0;
+		float h2 = up < MAX_SEARCH ? stepHeight(edgesAt(topEnd).g > 0.0, edgesAt(topEnd + ivec2(-1, 0)).g > 0.0) : 0.0;
+
+		weights.g = area(float(down), float(down + up + 1), h1, h2);
+	}
+}
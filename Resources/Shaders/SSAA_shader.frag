@@ -10,24 +10,19 @@ in vec2 texCoord;
 
 layout (location=0) out vec4 fragColour;
 
+// Single pass samples x samples box filter, kept for TexturedQuad's SSAA mode.
+// SSAAResolver does the same filter in two separable passes and is what the house scene uses.
 void main(void) {
-	float tx = 1.0 / (screenWidth * samples);
-    float ty = 1.0 / (screenHeight * samples);
+	// The block of supersampled texels covered by this output pixel
+	ivec2 outPos = min(ivec2(texCoord * vec2(screenWidth, screenHeight)), ivec2(screenWidth - 1, screenHeight - 1));
+	ivec2 first = outPos * samples;
 
 	vec4 newColour = vec4(0.0, 0.0, 0.0, 0.0);
 
-	int size = samples / 2;
-	int totalSize = (samples + 1) * (samples + 1);
-
-	for (int y = -size; y <= size; y++) {
-		for (int x = -size; x <= size; x++) {
-			vec2 pos = texCoord + vec2(float(x), float(y));
-
-			vec2 diff = vec2(float(x) * tx, float(y) * ty);
-
-			newColour += texture(texture0, pos + diff) / totalSize;
-		}
+	for (int y = 0; y < samples; y++) {
+		for (int x = 0; x < samples; x++)
+			newColour += texelFetch(texture0, first + ivec2(x, y), 0);
 	}
 
-	fragColour = newColour;
-}
\ No newline at end of file
+	fragColour = newColour / float(samples * samples);
+}
@@ -0,0 +1,37 @@
+#version 330
+
+//
+// One axis of a box filter downsample by a fractional factor (dynamic resolution).
+// An output pixel covers 'scale' source texels along 'direction', starting part way through a
+// texel, so each texel is weighted by how much of it lies inside the footprint.
+// Reads only the bottom left region of the source that was rendered to.
+//
+uniform sampler2D texture0;
+
+uniform float scale;
+uniform ivec2 direction; // (1, 0) for the horizontal pass, (0, 1) for the vertical pass
+uniform ivec2 sourceSize; // size of the rendered region of texture0
+
+layout (location=0) out vec4 fragColour;
+
+void main(void) {
+	ivec2 outPos = ivec2(gl_FragCoord.xy);
+	int axisPos = direction.x == 1 ? outPos.x : outPos.y;
+
+	float start = float(axisPos) * scale;
+	float end = start + scale;
+
+	int first = int(floor(start));
+	int last = int(ceil(end)) - 1;
+
+	vec4 newColour = vec4(0.0);
+
+	for (int i = first; i <= last; i++) {
+		float weight = min(end, float(i + 1)) - max(start, float(i));
+		ivec2 pos = direction.x == 1 ? ivec2(i, outPos.y) : ivec2(outPos.x, i);
+
+		newColour += texelFetch(texture0, min(pos, sourceSize - ivec2(1)), 0) * weight;
+	}
+
+	fragColour = newColour / scale;
+}
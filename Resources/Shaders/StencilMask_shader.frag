@@ -0,0 +1,16 @@
+#version 330
+
+//
+// Copies a mask texture into the stencil buffer. Draw with colour writes off and the stencil op set
+// to replace, every pixel that isn't masked is discarded so only the masked ones are written.
+//
+uniform sampler2D maskTexture;
+
+layout (location=0) out vec4 fragColour;
+
+void main(void) {
+	if (texelFetch(maskTexture, ivec2(gl_FragCoord.xy), 0).r < 0.5)
+		discard;
+
+	fragColour = vec4(1.0);
+}
@@ -0,0 +1,68 @@
+#version 330
+
+//
+// Temporal anti-aliasing resolve.
+// The scene is rendered with a different sub-pixel jitter every frame and blended into a history
+// buffer, so over a few frames every pixel averages many sample positions at 1x shading cost.
+// The history is reprojected with the depth buffer and last frame's view-projection so the camera
+// can move, then clamped to the colour range of the current 3x3 neighbourhood so disoccluded or
+// changed pixels don't ghost.
+//
+uniform sampler2D currentTexture;
+uniform sampler2D depthTexture;
+uniform sampler2D historyTexture;
+
+// Maps this frame's NDC (unjittered) to last frame's clip space
+uniform mat4 reprojection;
+
+// Weight of the current frame, lower is smoother but slower to react
+uniform float blendFactor;
+
+// False on the first frame after a reset, the history is garbage then
+uniform bool historyValid;
+
+layout (location=0) out vec4 fragColour;
+layout (location=1) out vec4 historyColour;
+
+void main(void) {
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	ivec2 maxPixel = textureSize(currentTexture, 0) - ivec2(1);
+	vec2 size = vec2(textureSize(currentTexture, 0));
+
+	vec4 current = texelFetch(currentTexture, pixel, 0);
+
+	// Colour range and closest depth of the neighbourhood. Reprojecting with the closest depth keeps
+	// the edges of foreground objects moving with the object rather than the background.
+	vec4 minColour = current;
+	vec4 maxColour = current;
+	float closestDepth = 1.0;
+
+	for (int y = -1; y <= 1; y++) {
+		for (int x = -1; x <= 1; x++) {
+			ivec2 neighbour = clamp(pixel + ivec2(x, y), ivec2(0), maxPixel);
+
+			vec4 colour = texelFetch(currentTexture, neighbour, 0);
+			minColour = min(minColour, colour);
+			maxColour = max(maxColour, colour);
+
+			closestDepth = min(closestDepth, texelFetch(depthTexture, neighbour, 0).r);
+		}
+	}
+
+	vec4 result = current;
+
+	if (historyValid) {
+		vec4 ndc = vec4(gl_FragCoord.xy / size * 2.0 - 1.0, closestDepth * 2.0 - 1.0, 1.0);
+		vec4 previous = reprojection * ndc;
+		vec2 previousUV = (previous.xy / previous.w) * 0.5 + 0.5;
+
+		// Anything that was off screen last frame has no history to use
+		if (all(greaterThanEqual(previousUV, vec2(0.0))) && all(lessThanEqual(previousUV, vec2(1.0)))) {
+			vec4 history = clamp(texture(historyTexture, previousUV), minColour, maxColour);
+			result = mix(history, current, blendFactor);
+		}
+	}
+
+	fragColour = result;
+	historyColour = result;
+}
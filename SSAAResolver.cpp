@@ -0,0 +1,398 @@
+#include "SSAAResolver.h"
+#include "ShaderVariants.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Number of output rows checked by verify()
+static const int VERIFY_ROWS = 16;
+
+// Must match MAX_TAPS in FilterResolve_shader.frag
+static const int MAX_FILTER_TAPS = 128;
+
+static const float PI = 3.14159265f;
+
+// Filter kernels, x is the distance from the output pixel centre in output pixels
+static float filterRadius(ResolveFilter filter) {
+	switch (filter) {
+		case RESOLVE_MITCHELL:
+			return 2.0f;
+		case RESOLVE_LANCZOS:
+			return 3.0f;
+		case RESOLVE_GAUSSIAN:
+			return 1.5f;
+		default:
+			return 0.5f;
+	}
+}
+
+static float filterKernel(ResolveFilter filter, float x) {
+	x = fabs(x);
+
+	switch (filter) {
+		case RESOLVE_MITCHELL: {
+			// Mitchell-Netravali with B = C = 1/3
+			const float B = 1.0f / 3.0f, C = 1.0f / 3.0f;
+
+			if (x < 1.0f)
+				return ((12 - 9 * B - 6 * C) * x * x * x + (-18 + 12 * B + 6 * C) * x * x + (6 - 2 * B)) / 6.0f;
+			if (x < 2.0f)
+				return ((-B - 6 * C) * x * x * x + (6 * B + 30 * C) * x * x + (-12 * B - 48 * C) * x + (8 * B + 24 * C)) / 6.0f;
+			return 0.0f;
+		}
+		case RESOLVE_LANCZOS: {
+			// Lanczos 3
+			if (x < 1e-5f)
+				return 1.0f;
+			if (x >= 3.0f)
+				return 0.0f;
+			return 3.0f * sin(PI * x) * sin(PI * x / 3.0f) / (PI * PI * x * x);
+		}
+		case RESOLVE_GAUSSIAN: {
+			// Sigma of half an output pixel, cut off at 3 sigma
+			const float sigma = 0.5f;
+			return x < 1.5f ? exp(-x * x / (2.0f * sigma * sigma)) : 0.0f;
+		}
+		default:
+			return x < 0.5f ? 1.0f : 0.0f;
+	}
+}
+
+bool parseResolveFilter(const string &name, ResolveFilter *filter) {
+	if (name == "box")
+		*filter = RESOLVE_BOX;
+	else if (name == "mitchell")
+		*filter = RESOLVE_MITCHELL;
+	else if (name == "lanczos")
+		*filter = RESOLVE_LANCZOS;
+	else if (name == "gaussian")
+		*filter = RESOLVE_GAUSSIAN;
+	else
+		return false;
+
+	return true;
+}
+
+const char *resolveFilterName(ResolveFilter filter) {
+	switch (filter) {
+		case RESOLVE_BOX:
+			return "box";
+		case RESOLVE_MITCHELL:
+			return "mitchell";
+		case RESOLVE_LANCZOS:
+			return "lanczos";
+		case RESOLVE_GAUSSIAN:
+			return "gaussian";
+	}
+
+	return "unknown";
+}
+
+SSAAResolver::SSAAResolver(int newOutputWidth, int newOutputHeight, int sampleSize, int tileSize) {
+	outputWidth = newOutputWidth;
+	outputHeight = newOutputHeight;
+	samples = sampleSize;
+
+	// The horizontal pass narrows the source by samples but keeps its height
+	intermediateWidth = tileSize > 0 ? min(tileSize / samples, outputWidth) : outputWidth;
+	intermediateHeight = tileSize > 0 ? min(tileSize, outputHeight * samples) : outputHeight * samples;
+
+	GLSL_ERROR glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/BoxResolve_shader.frag"),
+		&boxResolveShader);
+
+	sourceTextureLocation = glGetUniformLocation(boxResolveShader, "texture0");
+	samplesLocation = glGetUniformLocation(boxResolveShader, "samples");
+	directionLocation = glGetUniformLocation(boxResolveShader, "direction");
+	outputOffsetLocation = glGetUniformLocation(boxResolveShader, "outputOffset");
+
+	glUseProgram(boxResolveShader);
+	glUniform1i(sourceTextureLocation, 0);
+	glUniform1i(samplesLocation, samples);
+	glUseProgram(0);
+
+	glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/ScaledResolve_shader.frag"),
+		&scaledResolveShader);
+
+	scaleLocation = glGetUniformLocation(scaledResolveShader, "scale");
+	scaledDirectionLocation = glGetUniformLocation(scaledResolveShader, "direction");
+	sourceSizeLocation = glGetUniformLocation(scaledResolveShader, "sourceSize");
+
+	glUseProgram(scaledResolveShader);
+	glUniform1i(glGetUniformLocation(scaledResolveShader, "texture0"), 0);
+	glUseProgram(0);
+
+	glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/FilterResolve_shader.frag"),
+		&filterResolveShader);
+
+	filterDirectionLocation = glGetUniformLocation(filterResolveShader, "direction");
+	filterFirstTapLocation = glGetUniformLocation(filterResolveShader, "firstTap");
+	filterTapCountLocation = glGetUniformLocation(filterResolveShader, "tapCount");
+	filterWeightsLocation = glGetUniformLocation(filterResolveShader, "weights");
+
+	glUseProgram(filterResolveShader);
+	glUniform1i(glGetUniformLocation(filterResolveShader, "texture0"), 0);
+	glUniform1i(glGetUniformLocation(filterResolveShader, "samples"), samples);
+	glUseProgram(0);
+
+	glGenVertexArrays(1, &emptyVAO);
+
+	fboOkay = true;
+
+	// The intermediate holds sums of up to 'samples' texels, keep it in half float so
+	// the final result only gets rounded once
+	intermediateFBO = createTarget(intermediateWidth, intermediateHeight, GL_RGBA16F, &intermediateTexture);
+	outputFBO = createTarget(outputWidth, outputHeight, GL_RGBA8, &outputTexture);
+}
+
+SSAAResolver::~SSAAResolver() {
+	glDeleteFramebuffers(1, &intermediateFBO);
+	glDeleteFramebuffers(1, &outputFBO);
+	glDeleteTextures(1, &intermediateTexture);
+	glDeleteTextures(1, &outputTexture);
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(boxResolveShader);
+	glDeleteProgram(scaledResolveShader);
+	glDeleteProgram(filterResolveShader);
+}
+
+GLuint SSAAResolver::createTarget(int width, int height, GLint internalFormat, GLuint *texture) {
+	GLuint fbo;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+	// Linear filtering is what lets one fetch average a pair of texels in the next pass
+	glGenTextures(1, texture);
+	glBindTexture(GL_TEXTURE_2D, *texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, *texture, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		fboOkay = false;
+		cout << "Could not successfully create framebuffer object for the SSAA resolve!" << endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return fbo;
+}
+
+void SSAAResolver::runPass(GLuint sourceTexture, GLuint targetFBO, int x, int y, int width, int height, int dirX, int dirY) {
+	glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+	glViewport(x, y, width, height);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, sourceTexture);
+	glUniform2i(directionLocation, dirX, dirY);
+	glUniform2i(outputOffsetLocation, x, y);
+
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void SSAAResolver::resolve(GLuint sourceTexture) {
+	if (filter == RESOLVE_BOX)
+		resolveRegion(sourceTexture, 0, 0, outputWidth, outputHeight);
+	else
+		resolveFiltered(sourceTexture);
+}
+
+// Works out the tap weights for the current factor. Every output pixel covers the same pattern
+// of source texels, so one set of weights (normalised to sum to 1) serves the whole image.
+void SSAAResolver::setFilter(ResolveFilter newFilter) {
+	filter = newFilter;
+	filterWeights.clear();
+
+	if (filter == RESOLVE_BOX)
+		return;
+
+	int reach = (int)ceil(filterRadius(filter) * samples);
+	filterFirstTap = -reach;
+
+	float total = 0.0f;
+	for (int i = -reach; i < samples + reach; i++) {
+		// Distance from the output pixel centre to the centre of source texel i, in output pixels
+		float x = (i + 0.5f - samples * 0.5f) / samples;
+		float weight = filterKernel(filter, x);
+
+		if (filterWeights.empty() && weight == 0.0f) {
+			filterFirstTap++;
+			continue;
+		}
+
+		filterWeights.push_back(weight);
+		total += weight;
+	}
+
+	while (!filterWeights.empty() && filterWeights.back() == 0.0f)
+		filterWeights.pop_back();
+
+	for (float &weight : filterWeights)
+		weight /= total;
+
+	if ((int)filterWeights.size() > MAX_FILTER_TAPS) {
+		cout << resolveFilterName(filter) << " filter needs " << filterWeights.size() << " taps at x" << samples
+			<< ", more than the shader supports, using the box filter" << endl;
+		filter = RESOLVE_BOX;
+		filterWeights.clear();
+	}
+}
+
+ResolveFilter SSAAResolver::getFilter() {
+	return filter;
+}
+
+void SSAAResolver::resolveFiltered(GLuint sourceTexture) {
+	if (!fboOkay)
+		return;
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glUseProgram(filterResolveShader);
+	glUniform1i(filterFirstTapLocation, filterFirstTap);
+	glUniform1i(filterTapCountLocation, (int)filterWeights.size());
+	glUniform1fv(filterWeightsLocation, (GLsizei)filterWeights.size(), filterWeights.data());
+
+	glBindVertexArray(emptyVAO);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, intermediateFBO);
+	glViewport(0, 0, outputWidth, outputHeight * samples);
+	glBindTexture(GL_TEXTURE_2D, sourceTexture);
+	glUniform2i(filterDirectionLocation, 1, 0);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+	glViewport(0, 0, outputWidth, outputHeight);
+	glBindTexture(GL_TEXTURE_2D, intermediateTexture);
+	glUniform2i(filterDirectionLocation, 0, 1);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void SSAAResolver::resolveRegion(GLuint sourceTexture, int x, int y, int width, int height) {
+	if (!fboOkay)
+		return;
+
+	// Every output pixel is written so depth testing and blending aren't needed
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glUseProgram(boxResolveShader);
+	glBindVertexArray(emptyVAO);
+
+	runPass(sourceTexture, intermediateFBO, 0, 0, width, height * samples, 1, 0);
+	runPass(intermediateTexture, outputFBO, x, y, width, height, 0, 1);
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void SSAAResolver::resolveScaled(GLuint sourceTexture, int sourceWidth, int sourceHeight) {
+	if (!fboOkay)
+		return;
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glUseProgram(scaledResolveShader);
+	glBindVertexArray(emptyVAO);
+	glActiveTexture(GL_TEXTURE0);
+
+	// Horizontal: sourceWidth x sourceHeight down to outputWidth x sourceHeight
+	glBindFramebuffer(GL_FRAMEBUFFER, intermediateFBO);
+	glViewport(0, 0, outputWidth, sourceHeight);
+	glBindTexture(GL_TEXTURE_2D, sourceTexture);
+	glUniform1f(scaleLocation, (float)sourceWidth / outputWidth);
+	glUniform2i(scaledDirectionLocation, 1, 0);
+	glUniform2i(sourceSizeLocation, sourceWidth, sourceHeight);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	// Vertical: down to outputWidth x outputHeight
+	glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+	glViewport(0, 0, outputWidth, outputHeight);
+	glBindTexture(GL_TEXTURE_2D, intermediateTexture);
+	glUniform1f(scaleLocation, (float)sourceHeight / outputHeight);
+	glUniform2i(scaledDirectionLocation, 0, 1);
+	glUniform2i(sourceSizeLocation, outputWidth, sourceHeight);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GLuint SSAAResolver::getOutputTexture() {
+	return outputTexture;
+}
+
+int SSAAResolver::verify(GLuint sourceTexture) {
+	int sourceWidth = outputWidth * samples;
+	int rows = min(VERIFY_ROWS, outputHeight);
+
+	// Check a strip through the middle of the image where there's likely to be some edges
+	int firstRow = (outputHeight - rows) / 2;
+
+	vector<unsigned char> source(sourceWidth * rows * samples * 4);
+	vector<unsigned char> output(outputWidth * rows * 4);
+
+	// Attach the source texture to a temporary FBO so only the strip needs reading back
+	GLuint readFBO;
+	glGenFramebuffers(1, &readFBO);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sourceTexture, 0);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, firstRow * samples, sourceWidth, rows * samples, GL_RGBA, GL_UNSIGNED_BYTE, source.data());
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, outputFBO);
+	glReadPixels(0, firstRow, outputWidth, rows, GL_RGBA, GL_UNSIGNED_BYTE, output.data());
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &readFBO);
+
+	int maxError = 0;
+	for (int y = 0; y < rows; y++) {
+		for (int x = 0; x < outputWidth; x++) {
+			for (int c = 0; c < 4; c++) {
+				int sum = 0;
+				for (int sy = 0; sy < samples; sy++) {
+					for (int sx = 0; sx < samples; sx++)
+						sum += source[(((y * samples + sy) * sourceWidth) + x * samples + sx) * 4 + c];
+				}
+
+				float reference = (float)sum / (samples * samples);
+				int error = (int)(fabs(reference - output[(y * outputWidth + x) * 4 + c]) + 0.5f);
+				maxError = max(maxError, error);
+			}
+		}
+	}
+
+	cout << "SSAA resolve x" << samples << " max difference from reference box filter: " << maxError << endl;
+	return maxError;
+}
@@ -0,0 +1,100 @@
+#ifndef SSAARESOLVER_H
+#define SSAARESOLVER_H
+
+#include "Includes.h"
+#include <vector>
+
+// Reconstruction filter used for the downsample. Box is exact and cheapest, the others are wider
+// (2 to 3 output pixels) and trade a little blur or ringing for less aliasing.
+enum ResolveFilter { RESOLVE_BOX, RESOLVE_MITCHELL, RESOLVE_LANCZOS, RESOLVE_GAUSSIAN };
+const int RESOLVE_FILTER_COUNT = 4;
+
+// "box", "mitchell", "lanczos" or "gaussian", returns false for anything else
+bool parseResolveFilter(const std::string &name, ResolveFilter *filter);
+const char *resolveFilterName(ResolveFilter filter);
+
+// Downsamples a supersampled colour texture to the output resolution, by default with an exact box filter.
+// The filter is done as two separable passes (horizontal into an intermediate texture, then vertical)
+// and each pass reads texels in pairs with one bilinear fetch. The horizontal pass still runs at the
+// full supersampled height, so an output pixel costs samples * ceil(samples / 2) + ceil(samples / 2)
+// fetches, about samples^2 / 2 + samples / 2: half of a direct samples^2 box rather than linear in samples.
+// The other filters are separable too but fetch every tap, so they cost taps * (samples + 1) fetches
+// per output pixel rather than taps^2.
+class SSAAResolver {
+	private:
+		int								outputWidth;
+		int								outputHeight;
+		int								samples;
+
+		// Size of the intermediate, the whole image or one tile when rendering in tiles
+		int								intermediateWidth;
+		int								intermediateHeight;
+
+		// Horizontal pass result: outputWidth x (outputHeight * samples), or one tile's worth
+		GLuint							intermediateFBO;
+		GLuint							intermediateTexture;
+
+		// Final resolved image: outputWidth x outputHeight
+		GLuint							outputFBO;
+		GLuint							outputTexture;
+
+		bool							fboOkay;
+
+		// Fullscreen triangle is generated in the vertex shader, but core profile still needs a VAO bound
+		GLuint							emptyVAO;
+
+		GLuint							boxResolveShader;
+		GLint							sourceTextureLocation;
+		GLint							samplesLocation;
+		GLint							directionLocation;
+		GLint							outputOffsetLocation;
+
+		// Fractional factor filter for dynamic resolution
+		GLuint							scaledResolveShader;
+		GLint							scaleLocation;
+		GLint							scaledDirectionLocation;
+		GLint							sourceSizeLocation;
+
+		// Mitchell, Lanczos and Gaussian share one shader with the weights worked out for the factor
+		ResolveFilter					filter = RESOLVE_BOX;
+		std::vector<float>				filterWeights;
+		int								filterFirstTap = 0;
+
+		GLuint							filterResolveShader;
+		GLint							filterDirectionLocation;
+		GLint							filterFirstTapLocation;
+		GLint							filterTapCountLocation;
+		GLint							filterWeightsLocation;
+
+		void							resolveFiltered(GLuint sourceTexture);
+
+		GLuint							createTarget(int width, int height, GLint internalFormat, GLuint *texture);
+		void							runPass(GLuint sourceTexture, GLuint targetFBO, int x, int y, int width, int height, int dirX, int dirY);
+
+	public:
+		// tileSize is the largest source region resolveRegion() will be given, 0 for the whole image
+		SSAAResolver(int newOutputWidth, int newOutputHeight, int sampleSize, int tileSize = 0);
+		~SSAAResolver();
+
+		// Resolves sourceTexture ((outputWidth * samples) x (outputHeight * samples)) into the output texture
+		void resolve(GLuint sourceTexture);
+
+		// Only resolve() uses the filter, tiles and dynamic resolution always use the box filter
+		void setFilter(ResolveFilter newFilter);
+		ResolveFilter getFilter();
+
+		// Resolves the bottom left (width * samples) x (height * samples) texels of sourceTexture
+		// into the width x height rectangle of the output texture starting at x, y
+		void resolveRegion(GLuint sourceTexture, int x, int y, int width, int height);
+
+		// Resolves the bottom left sourceWidth x sourceHeight texels of sourceTexture, which can be any
+		// size up to (outputWidth * samples) x (outputHeight * samples), into the output texture
+		void resolveScaled(GLuint sourceTexture, int sourceWidth, int sourceHeight);
+
+		GLuint getOutputTexture();
+
+		// Compares a strip of the last resolve against a box filter done on the CPU.
+		// Returns the largest difference in 8-bit colour steps.
+		int verify(GLuint sourceTexture);
+};
+#endif
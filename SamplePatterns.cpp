@@ -0,0 +1,124 @@
+#include "SamplePatterns.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+float halton(int index, int base) {
+	float result = 0.0f;
+	float fraction = 1.0f / base;
+
+	while (index > 0) {
+		result += fraction * (index % base);
+		index /= base;
+		fraction /= base;
+	}
+
+	return result;
+}
+
+// n x n samples where every sample has its own column and row of an N x N grid (N = n^2),
+// so edges at any angle near horizontal or vertical still see N distinct coverage steps.
+// For n = 2 this is the usual 4x RGSS pattern.
+static vector<glm::vec2> rotatedGrid(int count) {
+	int n = max(1, (int)sqrt((float)count));
+	int total = n * n;
+
+	vector<glm::vec2> points;
+	for (int j = 0; j < n; j++) {
+		for (int i = 0; i < n; i++) {
+			float x = (i * n + j + 0.5f) / total;
+			float y = ((n - 1 - j) * n + i + 0.5f) / total;
+			points.push_back(glm::vec2(x - 0.5f, y - 0.5f));
+		}
+	}
+
+	return points;
+}
+
+// Halton (2, 3), skipping index 0 which would always put the first sample in the corner
+static vector<glm::vec2> haltonPoints(int count) {
+	vector<glm::vec2> points;
+	for (int i = 1; i <= count; i++)
+		points.push_back(glm::vec2(halton(i, 2) - 0.5f, halton(i, 3) - 0.5f));
+
+	return points;
+}
+
+// Dart throwing with a minimum distance relative to the ideal spacing. The random sequence is
+// seeded the same every time so stills come out identical between runs.
+static vector<glm::vec2> poissonPoints(int count) {
+	const int MAX_ATTEMPTS = 1000;
+
+	unsigned int seed = 12345;
+	auto random = [&seed]() {
+		seed = seed * 1664525u + 1013904223u;
+		return (seed >> 8) / 16777216.0f;
+	};
+
+	float minDistance = 0.75f / sqrt((float)count);
+
+	vector<glm::vec2> points;
+	while ((int)points.size() < count) {
+		bool placed = false;
+
+		for (int attempt = 0; attempt < MAX_ATTEMPTS && !placed; attempt++) {
+			glm::vec2 candidate(random() - 0.5f, random() - 0.5f);
+
+			placed = true;
+			for (size_t i = 0; i < points.size() && placed; i++)
+				placed = glm::length(points[i] - candidate) >= minDistance;
+
+			if (placed)
+				points.push_back(candidate);
+		}
+
+		// The square is full at this spacing, loosen it for the remaining samples
+		if (!placed)
+			minDistance *= 0.9f;
+	}
+
+	return points;
+}
+
+vector<glm::vec2> generateSamplePattern(SamplePattern pattern, int count) {
+	if (count <= 1)
+		return vector<glm::vec2>(1, glm::vec2(0.0f));
+
+	switch (pattern) {
+		case PATTERN_ROTATED_GRID:
+			return rotatedGrid(count);
+		case PATTERN_HALTON:
+			return haltonPoints(count);
+		case PATTERN_POISSON:
+			return poissonPoints(count);
+	}
+
+	return vector<glm::vec2>(1, glm::vec2(0.0f));
+}
+
+bool parseSamplePattern(const string &name, SamplePattern *pattern) {
+	if (name == "rotated")
+		*pattern = PATTERN_ROTATED_GRID;
+	else if (name == "halton")
+		*pattern = PATTERN_HALTON;
+	else if (name == "poisson")
+		*pattern = PATTERN_POISSON;
+	else
+		return false;
+
+	return true;
+}
+
+const char *samplePatternName(SamplePattern pattern) {
+	switch (pattern) {
+		case PATTERN_ROTATED_GRID:
+			return "rotated";
+		case PATTERN_HALTON:
+			return "halton";
+		case PATTERN_POISSON:
+			return "poisson";
+	}
+
+	return "unknown";
+}
@@ -0,0 +1,21 @@
+#ifndef SAMPLEPATTERNS_H
+#define SAMPLEPATTERNS_H
+
+#include "Includes.h"
+#include <vector>
+
+// Sub-pixel sample positions for jittered rendering. Offsets are in pixels relative to the pixel
+// centre, so every position lies in [-0.5, 0.5) on both axes.
+enum SamplePattern { PATTERN_ROTATED_GRID, PATTERN_HALTON, PATTERN_POISSON };
+
+// Rotated grid needs a square count, other counts are rounded down to the nearest square
+std::vector<glm::vec2> generateSamplePattern(SamplePattern pattern, int count);
+
+// i-th element (from 1) of the radical inverse sequence in the given base
+float halton(int index, int base);
+
+// "rotated", "halton" or "poisson", returns false for anything else
+bool parseSamplePattern(const std::string &name, SamplePattern *pattern);
+const char *samplePatternName(SamplePattern pattern);
+
+#endif
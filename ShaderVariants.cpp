@@ -0,0 +1,390 @@
+#include "ShaderVariants.h"
+#include "ProgramBinaryCache.h"
+#include "GLExtensions.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+ShaderVariants::~ShaderVariants() {
+	for (auto &variant : programs) {
+		if (variant.second)
+			glDeleteProgram(variant.second);
+	}
+
+	for (auto &building : pending) {
+		glDeleteShader(building.second.vertexShader);
+		glDeleteShader(building.second.fragmentShader);
+		glDeleteProgram(building.second.program);
+	}
+}
+
+// "NAME=value,..." in name order
+static string listDefines(const ShaderVariants::Defines &defines) {
+	string list;
+
+	for (auto &define : defines)
+		list += (list.empty() ? "" : ",") + define.first + "=" + to_string(define.second);
+
+	return list;
+}
+
+string ShaderVariants::makeKey(const string &vertexPath, const string &fragmentPath, const Defines &defines) {
+
+	return vertexPath + "|" + fragmentPath + "|" + listDefines(defines);
+}
+
+// Adds the time since start to total on the way out of a build step
+class StepTimer {
+	private:
+		chrono::high_resolution_clock::time_point start;
+		double *total;
+
+	public:
+		StepTimer(double *newTotal) {
+			start = chrono::high_resolution_clock::now();
+			total = newTotal;
+		}
+
+		~StepTimer() {
+			chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+			*total += elapsed.count();
+		}
+};
+
+GLuint ShaderVariants::get(const string &vertexPath, const string &fragmentPath, const Defines &defines) {
+	string key = makeKey(vertexPath, fragmentPath, defines);
+
+	auto found = programs.find(key);
+	if (found != programs.end())
+		return found->second;
+
+	// Requested earlier, finish it off now rather than building it again
+	auto building = pending.find(key);
+	if (building != pending.end()) {
+		completeBuild(&building->second);
+
+		GLuint program = building->second.program;
+		pending.erase(building);
+		return programs[key] = program;
+	}
+
+	GLuint program = 0;
+	createShaderProgram(vertexPath, fragmentPath, &program, defines);
+
+	programs[key] = program;
+	return program;
+}
+
+bool ShaderVariants::request(const string &vertexPath, const string &fragmentPath, const Defines &defines, GLuint *program) {
+	string key = makeKey(vertexPath, fragmentPath, defines);
+
+	auto found = programs.find(key);
+	if (found != programs.end()) {
+		*program = found->second;
+		return true;
+	}
+
+	*program = 0;
+	if (pending.count(key))
+		return false;
+
+	Build build;
+	build.vertexPath = vertexPath;
+	build.fragmentPath = fragmentPath;
+	build.defines = defines;
+
+	// Binaries load quickly enough not to be worth putting off
+	if (startBuild(&build)) {
+		*program = programs[key] = build.program;
+		return true;
+	}
+
+	// Without parallel compiling, glCompileShader can do all the work there and then, so it waits for update()
+	if (isParallel())
+		compileBuild(&build);
+
+	pending[key] = build;
+	return false;
+}
+
+void ShaderVariants::update() {
+	bool parallel = isParallel();
+	bool built = false;
+
+	for (auto building = pending.begin(); building != pending.end();) {
+		Build *build = &building->second;
+
+		if (parallel) {
+			if (!build->linking) {
+				if (!isComplete(build->vertexShader, false) || !isComplete(build->fragmentShader, false)) {
+					++building;
+					continue;
+				}
+				linkBuild(build);
+			}
+
+			// A failed compile doesn't get as far as a program
+			if (build->program && !isComplete(build->program, true)) {
+				++building;
+				continue;
+			}
+		} else {
+			if (built)
+				break;
+
+			compileBuild(build);
+			linkBuild(build);
+			built = true;
+		}
+
+		finishBuild(build);
+		programs[building->first] = build->program;
+		building = pending.erase(building);
+	}
+}
+
+void ShaderVariants::finish() {
+	for (auto &building : pending) {
+		completeBuild(&building.second);
+		programs[building.first] = building.second.program;
+	}
+
+	pending.clear();
+}
+
+int ShaderVariants::getVariantCount() {
+
+	return (int)programs.size();
+}
+
+int ShaderVariants::getPendingCount() {
+
+	return (int)pending.size();
+}
+
+bool ShaderVariants::isParallel() {
+
+	return GLExtensions::maxShaderCompilerThreads != nullptr;
+}
+
+GLSL_ERROR ShaderVariants::createShaderProgram(const string &vertexPath, const string &fragmentPath, GLuint *program, const Defines &defines) {
+	Build build;
+	build.vertexPath = vertexPath;
+	build.fragmentPath = fragmentPath;
+	build.defines = defines;
+
+	if (!startBuild(&build))
+		completeBuild(&build);
+
+	*program = build.program;
+	return build.result;
+}
+
+bool ShaderVariants::startBuild(Build *build) {
+	if (!readSource(build->vertexPath, &build->vertexSource)) {
+		build->result = GLSL_VERTEX_SHADER_SOURCE_NOT_FOUND;
+		return true;
+	}
+	if (!readSource(build->fragmentPath, &build->fragmentSource)) {
+		build->result = GLSL_FRAGMENT_SHADER_SOURCE_NOT_FOUND;
+		return true;
+	}
+
+	{
+		StepTimer timer(&build->ms);
+
+		// Keyed by the sources rather than the paths, so an edited shader is never loaded stale
+		build->cacheKey = ProgramBinaryCache::makeKey(build->vertexSource, build->fragmentSource, listDefines(build->defines));
+		build->program = ProgramBinaryCache::load(build->cacheKey);
+	}
+
+	if (build->program)
+		ProgramBinaryCache::recordBuild(true, build->ms);
+
+	return build->program != 0;
+}
+
+void ShaderVariants::completeBuild(Build *build) {
+	if (!build->compiling)
+		compileBuild(build);
+	if (!build->linking)
+		linkBuild(build);
+	finishBuild(build);
+}
+
+void ShaderVariants::compileBuild(Build *build) {
+	StepTimer timer(&build->ms);
+
+	build->vertexShader = startShader(GL_VERTEX_SHADER, build->vertexSource, build->defines);
+	build->fragmentShader = startShader(GL_FRAGMENT_SHADER, build->fragmentSource, build->defines);
+	build->compiling = true;
+}
+
+void ShaderVariants::linkBuild(Build *build) {
+	StepTimer timer(&build->ms);
+	build->linking = true;
+
+	// Both are checked so both sets of errors get printed
+	bool vertexOkay = checkShader(build->vertexShader, build->vertexPath, build->defines);
+	bool fragmentOkay = checkShader(build->fragmentShader, build->fragmentPath, build->defines);
+
+	if (!vertexOkay || !fragmentOkay) {
+		build->result = vertexOkay ? GLSL_FRAGMENT_SHADER_COMPILE_ERROR : GLSL_VERTEX_SHADER_COMPILE_ERROR;
+		return;
+	}
+
+	build->program = glCreateProgram();
+	ProgramBinaryCache::prepare(build->program);
+	glAttachShader(build->program, build->vertexShader);
+	glAttachShader(build->program, build->fragmentShader);
+	glLinkProgram(build->program);
+}
+
+void ShaderVariants::finishBuild(Build *build) {
+	StepTimer timer(&build->ms);
+
+	if (build->program) {
+		glDetachShader(build->program, build->vertexShader);
+		glDetachShader(build->program, build->fragmentShader);
+
+		if (checkProgram(build->program, makeKey(build->vertexPath, build->fragmentPath, build->defines))) {
+			ProgramBinaryCache::save(build->cacheKey, build->program);
+		} else {
+			glDeleteProgram(build->program);
+			build->program = 0;
+			build->result = GLSL_PROGRAM_OBJECT_LINK_ERROR;
+		}
+	}
+
+	// The program keeps what it needs once linked
+	glDeleteShader(build->vertexShader);
+	glDeleteShader(build->fragmentShader);
+	build->vertexShader = 0;
+	build->fragmentShader = 0;
+
+	// Includes the binary being written, that's part of what a cold start costs
+	if (build->program)
+		ProgramBinaryCache::recordBuild(false, build->ms);
+}
+
+bool ShaderVariants::isComplete(GLuint object, bool isProgram) {
+	GLint complete = GL_TRUE;
+
+	if (isProgram)
+		glGetProgramiv(object, GL_COMPLETION_STATUS_KHR, &complete);
+	else
+		glGetShaderiv(object, GL_COMPLETION_STATUS_KHR, &complete);
+
+	return complete == GL_TRUE;
+}
+
+bool ShaderVariants::readSource(const string &path, string *source) {
+	ifstream file(path);
+	if (!file) {
+		cout << "Couldn't open shader " << path << endl;
+		return false;
+	}
+
+	// Included files are looked for next to the file including them
+	string directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+	stringstream contents;
+	string line;
+	int lineNumber = 0;
+	int includeCount = 0;
+
+	while (getline(file, line)) {
+		lineNumber++;
+
+		size_t start = line.find_first_not_of(" \t");
+		if (start == string::npos || line.compare(start, 8, "#include") != 0) {
+			contents << line << "\n";
+			continue;
+		}
+
+		size_t nameStart = line.find('"', start);
+		size_t nameEnd = nameStart == string::npos ? string::npos : line.find('"', nameStart + 1);
+		if (nameEnd == string::npos) {
+			cout << path << "(" << lineNumber << "): #include needs a \"file\" name" << endl;
+			return false;
+		}
+
+		string includePath = directory + line.substr(nameStart + 1, nameEnd - nameStart - 1);
+		ifstream includeFile(includePath);
+		if (!includeFile) {
+			cout << path << "(" << lineNumber << "): couldn't open included shader " << includePath << endl;
+			return false;
+		}
+
+		// The included file is its own source string so errors in it give its own line numbers, then
+		// the numbering goes back to this file's
+		stringstream included;
+		included << includeFile.rdbuf();
+
+		includeCount++;
+		contents << "#line 1 " << includeCount << "\n" << included.str() << "\n";
+		contents << "#line " << lineNumber + 1 << " 0\n";
+	}
+
+	*source = contents.str();
+
+	return true;
+}
+
+GLuint ShaderVariants::startShader(GLenum type, const string &source, const Defines &defines) {
+	// Defines have to come after #version, which has to come before anything but comments
+	size_t versionStart = source.find("#version");
+	size_t insertAt = versionStart == string::npos ? 0 : source.find('\n', versionStart);
+	insertAt = insertAt == string::npos ? source.size() : insertAt + 1;
+
+	// #line puts the numbering back so errors point at the right line of the file
+	int nextLine = 1 + (int)count(source.begin(), source.begin() + insertAt, '\n');
+
+	string header;
+	for (auto &define : defines)
+		header += "#define " + define.first + " " + to_string(define.second) + "\n";
+	header += "#line " + to_string(nextLine) + "\n";
+
+	string variantSource = source.substr(0, insertAt) + header + source.substr(insertAt);
+	const char *sourceText = variantSource.c_str();
+
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &sourceText, NULL);
+	glCompileShader(shader);
+
+	return shader;
+}
+
+bool ShaderVariants::checkShader(GLuint shader, const string &path, const Defines &defines) {
+	GLint compiled;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (!compiled) {
+		GLint logLength;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+		string log(max(logLength, 1), '\0');
+		glGetShaderInfoLog(shader, logLength, NULL, &log[0]);
+
+		cout << "Couldn't compile " << path << " with " << (defines.empty() ? "no defines" : listDefines(defines)) << ":" << endl << log.c_str() << endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool ShaderVariants::checkProgram(GLuint program, const string &key) {
+	GLint linked;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (!linked) {
+		GLint logLength;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+		string log(max(logLength, 1), '\0');
+		glGetProgramInfoLog(program, logLength, NULL, &log[0]);
+
+		cout << "Couldn't link " << key << ":" << endl << log.c_str() << endl;
+		return false;
+	}
+
+	return true;
+}
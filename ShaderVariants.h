@@ -0,0 +1,103 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include "Includes.h"
+#include <map>
+
+// Builds programs from shader files with #defines added after their #version line, so one source can
+// be compiled into specialised versions (a light count baked in, texturing or specular left out)
+// instead of branching on uniforms at runtime. Each variant is compiled the first time it's asked for
+// and kept by its files and defines, so asking again is only a lookup.
+//
+// ShaderLoader only takes whole files, so the compiling and linking is done here. Errors are printed
+// with the defines of the variant that failed, and line numbers match the file. Shaders can share
+// code with #include "file" (relative to the shader, one level deep). An error in an included file
+// is reported as source string 1 (2 for the second include, ...) with that file's line numbers. Every program is
+// looked for in the ProgramBinaryCache first and saved to it after linking, so the other classes
+// build their programs through createShaderProgram() too (a drop in for ShaderLoader's).
+//
+// Variants can also be built without waiting for them, see request(). With KHR_parallel_shader_compile
+// the driver compiles and links on its own threads and update() polls GL_COMPLETION_STATUS_KHR,
+// without it the builds are queued and update() does one at a time, so a frame only ever stalls for
+// one program rather than all of them.
+class ShaderVariants {
+	public:
+		// Name to value, flags are given 1. Sorted, so the same set always makes the same key.
+		typedef std::map<std::string, int> Defines;
+
+	private:
+		// A program on its way from source files to linked
+		struct Build {
+			std::string					vertexPath;
+			std::string					fragmentPath;
+			Defines						defines;
+
+			std::string					vertexSource;
+			std::string					fragmentSource;
+			std::string					cacheKey;
+
+			GLuint						vertexShader = 0;
+			GLuint						fragmentShader = 0;
+			GLuint						program = 0;
+			bool						compiling = false;
+			bool						linking = false;
+			GLSL_ERROR					result = GLSL_OK;
+
+			// Time spent in the calls for it, which is what it cost the thread asking for it
+			double						ms = 0.0;
+		};
+
+		// 0 for variants that failed, so they're only reported once
+		std::map<std::string, GLuint>	programs;
+
+		// Requested and not finished yet, by key
+		std::map<std::string, Build>	pending;
+
+		// The steps of a build, in order. startBuild() returns true if it's already done (loaded from
+		// the cache or a source couldn't be read).
+		static bool						startBuild(Build *build);
+		static void						compileBuild(Build *build);
+		static void						linkBuild(Build *build);
+		static void						finishBuild(Build *build);
+
+		// Whatever steps are left, waiting for the driver if need be
+		static void						completeBuild(Build *build);
+
+		static bool						readSource(const std::string &path, std::string *source);
+		static GLuint					startShader(GLenum type, const std::string &source, const Defines &defines);
+		static bool						checkShader(GLuint shader, const std::string &path, const Defines &defines);
+		static bool						checkProgram(GLuint program, const std::string &key);
+
+		// False while the driver is still working on it in the background
+		static bool						isComplete(GLuint object, bool isProgram);
+
+	public:
+		~ShaderVariants();
+
+		// The program built from the two files with these defines, 0 if it couldn't be built. Waits for
+		// the build to finish if it was requested and hasn't yet.
+		GLuint get(const std::string &vertexPath, const std::string &fragmentPath, const Defines &defines = Defines());
+
+		// Starts building the variant if it hasn't been, without waiting for it. Returns true with the
+		// program (0 if it failed) once it's built, false while it's still being built.
+		bool request(const std::string &vertexPath, const std::string &fragmentPath, const Defines &defines, GLuint *program);
+
+		// Moves requested builds along, call once a frame
+		void update();
+
+		// Waits for every requested build to finish
+		void finish();
+
+		int getVariantCount();
+		int getPendingCount();
+
+		// True if the driver compiles in the background, otherwise requests are built one per update()
+		static bool isParallel();
+
+		// Builds a program the caller owns, from the binary cache when it can. Not kept by any ShaderVariants.
+		static GLSL_ERROR createShaderProgram(const std::string &vertexPath, const std::string &fragmentPath, GLuint *program, const Defines &defines = Defines());
+
+		// "vertex|fragment|NAME=value,..." as used for the cache
+		static std::string makeKey(const std::string &vertexPath, const std::string &fragmentPath, const Defines &defines);
+};
+#endif
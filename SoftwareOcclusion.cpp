@@ -0,0 +1,60 @@
+#include "SoftwareOcclusion.h"
+#include <cfloat>
+
+using namespace std;
+
+SoftwareOcclusion::SoftwareOcclusion(int newWidth, int newHeight, int threads) : OcclusionRasterizer(newWidth, newHeight, threads) {
+}
+
+// Model's meshes keep their vertices and triangle indices, so the file isn't read again
+void SoftwareOcclusion::addOccluder(Model *model, const glm::mat4 &modelMatrix) {
+	vector<glm::vec3> positions;
+
+	for (const Mesh &mesh : model->meshes) {
+		positions.clear();
+		for (const Vertex &vertex : mesh.vertices)
+			positions.push_back(vertex.Position);
+
+		addOccluder(positions, mesh.indices, modelMatrix);
+	}
+}
+
+bool SoftwareOcclusion::addOccluder(const string &path, const glm::mat4 &modelMatrix) {
+	Assimp::Importer importer;
+	const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate);
+
+	if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || scene->mNumMeshes == 0) {
+		cout << "Couldn't load " << path << " as an occluder: " << importer.GetErrorString() << endl;
+		return false;
+	}
+
+	vector<glm::vec3> positions;
+	vector<unsigned int> indices;
+
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+		const aiMesh *mesh = scene->mMeshes[m];
+
+		positions.clear();
+		for (unsigned int v = 0; v < mesh->mNumVertices; v++)
+			positions.push_back(glm::vec3(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z));
+
+		// Lines and points left over after triangulation don't hide anything
+		indices.clear();
+		for (unsigned int f = 0; f < mesh->mNumFaces; f++) {
+			const aiFace &face = mesh->mFaces[f];
+			if (face.mNumIndices == 3)
+				indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+		}
+
+		addOccluder(positions, indices, modelMatrix);
+	}
+
+	return true;
+}
+
+bool SoftwareOcclusion::isVisible(const BoundingBox &box) const {
+	if (box.min.x == -FLT_MAX)
+		return true;
+
+	return isVisible(box.min, box.max);
+}
@@ -0,0 +1,32 @@
+#ifndef SOFTWAREOCCLUSION_H
+#define SOFTWAREOCCLUSION_H
+
+#include "Frustum.h"
+#include "OcclusionRasterizer.h"
+
+// Occlusion culling on the CPU, nothing is drawn or read back on the GPU. Big occluder meshes (the
+// house and the land) are rasterized each frame into a small depth buffer, then object bounds are
+// tested against it before they're submitted, so the answer is there straight away rather than a
+// frame later like OcclusionCuller's queries.
+//
+// The rasterizing and testing is OcclusionRasterizer's, this adds taking occluders from models and
+// testing the scene's BoundingBoxes.
+class SoftwareOcclusion : public OcclusionRasterizer {
+	public:
+		// threads = 0 uses one per core (at most one per row of tiles)
+		SoftwareOcclusion(int newWidth, int newHeight, int threads = 0);
+
+		using OcclusionRasterizer::addOccluder;
+		using OcclusionRasterizer::isVisible;
+
+		// The triangles of every mesh of an already loaded model
+		void addOccluder(Model *model, const glm::mat4 &modelMatrix);
+
+		// Loads the triangles of every mesh in a model file, false if it couldn't be loaded. For when
+		// there's no GL context to load a Model with, e.g. the occlusion benchmark.
+		bool addOccluder(const std::string &path, const glm::mat4 &modelMatrix);
+
+		// As OcclusionRasterizer's, and boxes without bounds are always visible
+		bool isVisible(const BoundingBox &box) const;
+};
+#endif
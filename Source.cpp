@@ -1,5 +1,27 @@
 #include "Includes.h"
 #include "HouseScene.h"
+#include "CommandLine.h"
+#include "FrameCapture.h"
+#include "FrameStats.h"
+#include "GLExtensions.h"
+#include "GPUProfiler.h"
+#include "HeadlessContext.h"
+#include "LightBenchmark.h"
+#include "AAQualityBenchmark.h"
+#include "OcclusionBenchmark.h"
+#include "PostProcessAA.h"
+#include "ProgramBinaryCache.h"
+#include "ResolutionController.h"
+#include "ResolveBenchmark.h"
+#include "AccumulationRenderer.h"
+#include "AdaptiveSupersampler.h"
+#include "SSAAResolver.h"
+#include "TemporalAA.h"
+#include "TiledRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 
 // Function prototypes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -7,13 +29,52 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
-void avgFPS(const float);
-
-enum AATYPE { NONE, MSAA, SSAA };
+void finishBenchmark();
+void setupRenderSettings();
+void createScenes();
+void setupHouseScene();
+void applySettings();
+void renderFrame(GLuint targetFBO, int width, int height, float timeDelta);
+int runHeadless(const AppSettings &settings);
+int runResolveBench(const AppSettings &settings);
+int runLightBench(const AppSettings &settings);
+int runAAQualityBench();
+
+enum AATYPE { NONE, MSAA, SSAA, ACCUM, TAA, ADAPTIVE, FXAA, SMAA };
+const int AATYPE_COUNT = 8;
 
 const int SCREEN_WIDTH = 1000, SCREEN_HEIGHT = 800;
-const int ANTIALAISING_TYPE = SSAA;
-const int SAMPLES = 8; //resolution multiplier and samples for SSAA & MSAA
+
+// Anti-aliasing settings, these can be changed at runtime (M cycles the type, 1-5 pick the samples)
+AATYPE antialiasingType = SSAA;
+int samples = 8; //resolution multiplier and samples for SSAA & MSAA
+
+// MSAA options (B switches the resolve between blit and shader, V toggles per-sample shading)
+MSAAResolveMode msaaResolveMode = MSAA_RESOLVE_BLIT;
+bool sampleShading = false;
+
+// SSAA tile size in texels, 0 renders the whole supersampled image at once (T toggles tiling)
+int ssaaTileSize = 0;
+const int DEFAULT_SSAA_TILE_SIZE = 1024;
+
+// Filter used to downsample SSAA (F cycles it)
+ResolveFilter resolveFilter = RESOLVE_BOX;
+
+// Forward or deferred lighting (G toggles it), MSAA always renders forward
+ShadingPath shadingPath = SHADING_FORWARD;
+
+// Dynamic resolution for SSAA: the scale is picked every frame to keep the scene pass near this
+// GPU time, 0 uses the fixed factor (R toggles it)
+float dynamicResTargetMs = 0.0f;
+float dynamicResMaxScale = 2.0f;
+const float DEFAULT_DYNAMIC_RES_TARGET_MS = 8.0f;
+
+// Accumulation and adaptive options, 0 samples means samples^2 so it matches SSAA at the same setting (J cycles the pattern)
+int accumSamples = 0;
+SamplePattern jitterPattern = PATTERN_ROTATED_GRID;
+
+// Current size of the output (the window or the headless capture)
+int screenWidth = SCREEN_WIDTH, screenHeight = SCREEN_HEIGHT;
 
 // Camera settings
 // width, heigh, near plane, far plane
@@ -31,11 +92,51 @@ double lastY = camera_settings.screenHeight / 2.0f;
 bool			showHouseQuad = true;
 HouseScene		*houseScene = nullptr;
 
+SSAAResolver	*ssaaResolver = nullptr;
+TiledRenderer	*tiledRenderer = nullptr;
+AccumulationRenderer	*accumulationRenderer = nullptr;
+TemporalAA		*temporalAA = nullptr;
+AdaptiveSupersampler	*adaptiveSupersampler = nullptr;
+PostProcessAA	*postProcessAA = nullptr;
+ResolutionController	*resolutionController = nullptr;
 TexturedQuad	*houseQuad = nullptr;
 TexturedQuad	*texturedQuad = nullptr;
 
-int main()
+AppSettings		appSettings;
+FrameStats		*frameStats = nullptr;
+GPUProfiler		*gpuProfiler = nullptr;
+
+// For timing how long the first frame takes to appear, which is mostly building shader programs
+std::chrono::high_resolution_clock::time_point startupTime;
+
+int main(int argc, char **argv)
 {
+	startupTime = std::chrono::high_resolution_clock::now();
+
+	if (!parseCommandLine(argc, argv, &appSettings))
+		return -1;
+
+	applySettings();
+
+	if (appSettings.benchmark)
+		frameStats = new FrameStats(appSettings.benchWarmupSeconds, appSettings.benchFrames, appSettings.benchBucketMs);
+
+	if (appSettings.resolveBench)
+		return runResolveBench(appSettings);
+
+	// CPU only, no context needed
+	if (appSettings.occlusionBench)
+		return runOcclusionBenchmark() ? 0 : -1;
+
+	if (appSettings.lightBench)
+		return runLightBench(appSettings);
+
+	if (appSettings.aaQuality)
+		return runAAQualityBench();
+
+	if (appSettings.headless)
+		return runHeadless(appSettings);
+
 	// glfw: initialize and configure
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -43,9 +144,6 @@ int main()
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-	if (ANTIALAISING_TYPE == MSAA)
-		glfwWindowHint(GLFW_SAMPLES, SAMPLES);
-
 	// glfw window creation
 	GLFWwindow* window = glfwCreateWindow(camera_settings.screenWidth, camera_settings.screenHeight, "CS3S664 OpenGL Assignment 1 - 15029476 | William Akins", NULL, NULL);
 	if (window == NULL)
@@ -72,31 +170,16 @@ int main()
 		return -1;
 	}
 
-	//Rendering settings
-	glfwSwapInterval(0);		// glfw enable swap interval to match screen v-sync
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE); //Enables face culling
-	glFrontFace(GL_CCW);//Specifies which winding order if front facing
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLExtensions::load((GLADloadproc)glfwGetProcAddress);
 
-	if (ANTIALAISING_TYPE == MSAA)
-		glEnable(GL_MULTISAMPLE);
+	glfwSwapInterval(0);		// glfw enable swap interval to match screen v-sync
+	setupRenderSettings();
 
 	TextRenderer textRenderer(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 	bool leftCtrlPressed = false;
 
-	//earthScene = new EarthScene();
-	texturedQuad = new TexturedQuad(string("Resources\\Models\\bumblebee.png"));
-
-	if (ANTIALAISING_TYPE == NONE || ANTIALAISING_TYPE == MSAA) {
-		houseScene = new HouseScene(SCREEN_WIDTH, SCREEN_HEIGHT, 1);
-		houseQuad = new TexturedQuad(houseScene->getHouseSceneTexture(), false, SCREEN_WIDTH, SCREEN_HEIGHT, 1, true);
-	} else { //else use SSAA
-		houseScene = new HouseScene(SCREEN_WIDTH, SCREEN_HEIGHT, SAMPLES);
-		houseQuad = new TexturedQuad(houseScene->getHouseSceneTexture(), true, SCREEN_WIDTH, SCREEN_HEIGHT, SAMPLES, true);
-	}
+	createScenes();
 
 	// render loop
 	while (!glfwWindowShouldClose(window))
@@ -105,39 +188,31 @@ int main()
 		processInput(window);
 		timer.tick();
 
-		if (houseScene)
-			houseScene->render();
-
-		// Clear the screen
-		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		//Reset the viewport
 		int width, height;
 		glfwGetFramebufferSize(window, &width, &height);
-		glViewport(0, 0, width, height);
+		renderFrame(0, width, height, timer.getDeltaTimeSeconds());
 
 		static const char *AATypeText[] = {
 			"NONE",
 			"MSAA x",
 			"SSAA x",
+			"ACCUM x",
+			"TAA",
+			"ADAPTIVE x",
+			"FXAA",
+			"SMAA",
 		};
-		//if (ANTIALAISING_TYPE != NONE)
-			//textRenderer.renderText(AATypeText[ANTIALAISING_TYPE] + std::to_string(SAMPLES), 5.0f, 30.0f, 0.6f, glm::vec3(1.0, 1.0f, 1.0f));
+		//if (antialiasingType != NONE)
+			//textRenderer.renderText(AATypeText[antialiasingType] + std::to_string(samples), 5.0f, 30.0f, 0.6f, glm::vec3(1.0, 1.0f, 1.0f));
 		//textRenderer.renderText("FPS: " + std::to_string(timer.averageFPS()) + " SPF: " + std::to_string(timer.currentSPF()), 5.0f, 5.0f, 0.6f, glm::vec3(1.0, 1.0f, 1.0f));
 
-		//avgFPS(timer.getDeltaTimeSeconds());
+		if (frameStats && !frameStats->isFinished()) {
+			frameStats->addFrame(timer.getDeltaTimeSeconds());
 
-		// Update houseScene state
-		if (houseScene)
-			houseScene->update(timer.getDeltaTimeSeconds());
-
-		if (showHouseQuad) {
-			if (houseQuad)
-				houseQuad->render();
-		} else {
-			if (texturedQuad)
-				texturedQuad->render();
+			if (frameStats->isFinished()) {
+				finishBenchmark();
+				glfwSetWindowShouldClose(window, true);
+			}
 		}
 
 		// glfw: swap buffers and poll events
@@ -149,36 +224,415 @@ int main()
 	glfwTerminate();
 	return 0;
 }
-void avgFPS(const float timeDelta) {
-	static float deltaTime = 0.0f;
-	deltaTime += 1.0f * timeDelta;
-
-	const int numOfFrames = 5000;
-
-	static bool finished = false;
-	static float fps[numOfFrames];
-	static float spf[numOfFrames];
-	static int frameCount = 0;
-
-	if (deltaTime > 3.0f && !finished) {
-		if (frameCount < numOfFrames) {
-			fps[frameCount] = timer.averageFPS();
-			spf[frameCount] = timer.currentSPF();
-			frameCount++;
+
+void setupRenderSettings() {
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE); //Enables face culling
+	glFrontFace(GL_CCW);//Specifies which winding order if front facing
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void createScenes() {
+	if (appSettings.profile) {
+		gpuProfiler = new GPUProfiler();
+
+		if (!appSettings.profileCSV.empty())
+			gpuProfiler->openCSV(appSettings.profileCSV);
+	}
+
+	//earthScene = new EarthScene();
+	texturedQuad = new TexturedQuad(string("Resources/Models/bumblebee.png"));
+
+	houseScene = new HouseScene(screenWidth, screenHeight, 1);
+	houseScene->setFenceRings(appSettings.fenceRings);
+	houseScene->setOcclusionCulling(appSettings.occlusionCulling);
+	houseScene->setSoftwareOcclusion(appSettings.softwareOcclusion);
+	houseScene->setExtraLights(appSettings.extraLights);
+	houseScene->setLightClustering(appSettings.lightClustering);
+	houseScene->setShadingPath(shadingPath);
+	setupHouseScene();
+}
+
+// Applies the current anti-aliasing settings and output size to the house scene.
+// Only the render targets and the resolve quad are recreated, the scene's assets stay loaded.
+void setupHouseScene() {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	bool dynamicResolution = antialiasingType == SSAA && dynamicResTargetMs > 0.0f;
+
+	// Dynamic resolution allocates for the largest scale once and renders into part of it
+	int factor = antialiasingType == SSAA ? samples : 1;
+	if (dynamicResolution)
+		factor = (int)ceil(dynamicResMaxScale);
+
+	GLint maxTextureSize;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+	// A tile has to hold at least one output pixel's worth of samples
+	int tileSize = 0;
+	if (factor > 1 && ssaaTileSize > 0 && !dynamicResolution)
+		tileSize = std::min(std::max(ssaaTileSize, factor), (int)maxTextureSize);
+
+	// Without tiling don't ask for a supersampled target bigger than the driver supports
+	while (tileSize == 0 && factor > 1 && (screenWidth * factor > maxTextureSize || screenHeight * factor > maxTextureSize))
+		factor /= 2;
+
+	// MSAA renders the scene through a multisampled FBO, the window itself is never multisampled.
+	// The samples go in with the size so the FBO is only reallocated once.
+	houseScene->setTileSize(tileSize);
+	houseScene->setMSAAOptions(sampleShading, msaaResolveMode);
+	houseScene->updateScene(screenWidth, screenHeight, factor, antialiasingType == MSAA ? samples : 1);
+
+	// Supersampled scenes are downsampled by the resolver, the quad then just shows the result 1:1
+	delete tiledRenderer;
+	tiledRenderer = nullptr;
+	delete ssaaResolver;
+	ssaaResolver = nullptr;
+	delete accumulationRenderer;
+	accumulationRenderer = nullptr;
+	delete temporalAA;
+	temporalAA = nullptr;
+	delete adaptiveSupersampler;
+	adaptiveSupersampler = nullptr;
+	delete postProcessAA;
+	postProcessAA = nullptr;
+	delete resolutionController;
+	resolutionController = nullptr;
+
+	int jitteredSamples = accumSamples > 0 ? accumSamples : samples * samples;
+
+	GLuint resolvedTexture = houseScene->getHouseSceneTexture();
+	if (antialiasingType == FXAA || antialiasingType == SMAA) {
+		postProcessAA = new PostProcessAA(antialiasingType == FXAA ? POSTAA_FXAA : POSTAA_SMAA, screenWidth, screenHeight);
+		resolvedTexture = postProcessAA->getOutputTexture();
+	} else if (antialiasingType == ADAPTIVE) {
+		adaptiveSupersampler = new AdaptiveSupersampler(houseScene, screenWidth, screenHeight, jitterPattern, jitteredSamples);
+		resolvedTexture = adaptiveSupersampler->getOutputTexture();
+	} else if (antialiasingType == TAA) {
+		temporalAA = new TemporalAA(screenWidth, screenHeight);
+		resolvedTexture = temporalAA->getOutputTexture();
+	} else if (antialiasingType == ACCUM) {
+		accumulationRenderer = new AccumulationRenderer(houseScene, screenWidth, screenHeight, jitterPattern, jitteredSamples);
+		resolvedTexture = accumulationRenderer->getOutputTexture();
+	} else if (factor > 1) {
+		ssaaResolver = new SSAAResolver(screenWidth, screenHeight, factor, tileSize);
+		ssaaResolver->setFilter(resolveFilter);
+		resolvedTexture = ssaaResolver->getOutputTexture();
+
+		// The controller is driven by the scene pass's GPU time, so it needs the profiler even without --profile
+		if (dynamicResolution) {
+			resolutionController = new ResolutionController(dynamicResTargetMs, 1.0f, std::min(dynamicResMaxScale, (float)factor));
+
+			if (!gpuProfiler)
+				gpuProfiler = new GPUProfiler();
+		}
+
+		if (tileSize > 0)
+			tiledRenderer = new TiledRenderer(houseScene, ssaaResolver, screenWidth, screenHeight, factor, tileSize);
+	}
+
+	delete houseQuad;
+	houseQuad = new TexturedQuad(resolvedTexture, false, screenWidth, screenHeight, 1, true);
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << "House scene set to " << screenWidth << "x" << screenHeight << " with SSAA factor " << factor
+		<< ", MSAA samples " << houseScene->getMSAASamples() << " (" << ms << " ms)" << std::endl;
+
+	if (accumulationRenderer)
+		std::cout << "Accumulating " << accumulationRenderer->getSampleCount() << " jittered renders ("
+			<< samplePatternName(jitterPattern) << " pattern)" << std::endl;
+
+	if (adaptiveSupersampler)
+		std::cout << "Supersampling edge pixels with " << adaptiveSupersampler->getSampleCount() << " jittered renders ("
+			<< samplePatternName(jitterPattern) << " pattern)" << std::endl;
+
+	if (resolutionController)
+		std::cout << "Dynamic resolution targeting " << dynamicResTargetMs << " ms for the scene, scale 1 to "
+			<< std::min(dynamicResMaxScale, (float)factor) << std::endl;
+
+	if (ssaaResolver && !tiledRenderer && !resolutionController)
+		std::cout << "Resolving SSAA with the " << resolveFilterName(ssaaResolver->getFilter()) << " filter" << std::endl;
+
+	if (tiledRenderer)
+		std::cout << "Rendering SSAA in " << tiledRenderer->getTileCount() << " tiles of up to " << tileSize << "x" << tileSize << std::endl;
+}
+
+// Copies anti-aliasing settings given on the command line over the defaults
+void applySettings() {
+	if (appSettings.aaType == "none")
+		antialiasingType = NONE;
+	else if (appSettings.aaType == "msaa")
+		antialiasingType = MSAA;
+	else if (appSettings.aaType == "ssaa")
+		antialiasingType = SSAA;
+	else if (appSettings.aaType == "accum")
+		antialiasingType = ACCUM;
+	else if (appSettings.aaType == "taa")
+		antialiasingType = TAA;
+	else if (appSettings.aaType == "adaptive")
+		antialiasingType = ADAPTIVE;
+	else if (appSettings.aaType == "fxaa")
+		antialiasingType = FXAA;
+	else if (appSettings.aaType == "smaa")
+		antialiasingType = SMAA;
+
+	if (appSettings.samples > 0)
+		samples = appSettings.samples;
+
+	msaaResolveMode = appSettings.msaaResolve == "shader" ? MSAA_RESOLVE_SHADER : MSAA_RESOLVE_BLIT;
+	sampleShading = appSettings.sampleShading;
+	ssaaTileSize = appSettings.ssaaTile;
+	accumSamples = appSettings.accumSamples;
+	dynamicResTargetMs = appSettings.dynamicResTargetMs;
+	dynamicResMaxScale = appSettings.dynamicResMaxScale;
+	parseSamplePattern(appSettings.jitterPattern, &jitterPattern);
+	parseResolveFilter(appSettings.resolveFilter, &resolveFilter);
+	parseShadingPath(appSettings.shading, &shadingPath);
+
+	ProgramBinaryCache::setEnabled(appSettings.shaderCache);
+	ProgramBinaryCache::setDirectory(appSettings.shaderCacheDir);
+}
+
+// Renders the house scene into its FBO, then resolves it into targetFBO (0 is the window)
+void renderFrame(GLuint targetFBO, int width, int height, float timeDelta) {
+	if (gpuProfiler)
+		gpuProfiler->beginFrame();
+
+	houseScene->beginFrame();
+
+	{
+		ProfileScope frameScope(gpuProfiler, "frame");
+
+		if (tiledRenderer) {
+			// Tiles interleave scene rendering and resolving so they're timed as one pass
+			ProfileScope tilesScope(gpuProfiler, "tiles");
+			tiledRenderer->render();
+		} else if (accumulationRenderer) {
+			ProfileScope accumulateScope(gpuProfiler, "accumulate");
+			accumulationRenderer->render();
+		} else if (adaptiveSupersampler) {
+			ProfileScope adaptiveScope(gpuProfiler, "adaptive");
+			adaptiveSupersampler->render();
+		} else if (temporalAA) {
+			{
+				ProfileScope sceneScope(gpuProfiler, "scene");
+				houseScene->render(temporalAA->getJitter(), screenWidth, screenHeight);
+			}
+
+			{
+				// Reprojection uses the camera without the jitter
+				ProfileScope taaScope(gpuProfiler, "taa");
+				Camera *sceneCamera = houseScene->getHouseSceneCamera();
+				glm::mat4 viewProjection = sceneCamera->getProjectionMatrix() * sceneCamera->getViewMatrix();
+				temporalAA->resolve(houseScene->getHouseSceneTexture(), houseScene->getHouseSceneDepthTexture(), viewProjection);
+			}
 		} else {
-			float fpsSum = 0;
-			float spfSum = 0;
-			for (int i = 0; i < numOfFrames; i++) {
-				fpsSum += fps[i];
-				spfSum += spf[i];
+			// With dynamic resolution only the bottom left sceneWidth x sceneHeight of the FBO is used
+			int sceneWidth = 0, sceneHeight = 0;
+
+			if (resolutionController) {
+				GPUProfiler::PassTiming sceneTiming;
+				if (gpuProfiler->getLatestPassTiming("scene", &sceneTiming))
+					resolutionController->update(sceneTiming.gpuMs, sceneTiming.frame);
+
+				sceneWidth = (int)(screenWidth * resolutionController->getScale() + 0.5f);
+				sceneHeight = (int)(screenHeight * resolutionController->getScale() + 0.5f);
+			}
+
+			{
+				ProfileScope sceneScope(gpuProfiler, "scene");
+
+				if (resolutionController)
+					houseScene->render(glm::mat4(1.0), sceneWidth, sceneHeight);
+				else if (houseScene)
+					houseScene->render();
+			}
+
+			if (postProcessAA) {
+				ProfileScope postScope(gpuProfiler, "post-aa");
+				postProcessAA->apply(houseScene->getHouseSceneTexture());
+			}
+
+			if (ssaaResolver) {
+				ProfileScope resolveScope(gpuProfiler, "resolve");
+
+				if (resolutionController)
+					ssaaResolver->resolveScaled(houseScene->getHouseSceneTexture(), sceneWidth, sceneHeight);
+				else
+					ssaaResolver->resolve(houseScene->getHouseSceneTexture());
+
+				if (appSettings.verifyResolve && !resolutionController) {
+					ssaaResolver->verify(houseScene->getHouseSceneTexture());
+					appSettings.verifyResolve = false;
+				}
+			}
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+
+		// Clear the screen
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		//Reset the viewport
+		glViewport(0, 0, width, height);
+
+		// Update houseScene state
+		if (houseScene)
+			houseScene->update(timeDelta);
+
+		{
+			ProfileScope presentScope(gpuProfiler, "present");
+
+			if (showHouseQuad) {
+				if (houseQuad)
+					houseQuad->render();
+			} else {
+				if (texturedQuad)
+					texturedQuad->render();
 			}
-			finished = true;
-			fpsSum /= numOfFrames;
-			spfSum /= numOfFrames;
-			std::cout << "Count finished, avg fps was: " << fpsSum;
-			std::cout << "Avg spf was: " << spfSum;
 		}
 	}
+
+	// The scene's shader variants build in the background and the first frame draws with what's ready,
+	// so both are reported. Run twice to compare a cold start (empty cache) with a warm one.
+	static bool firstFrameReported = false;
+	static bool programsReported = false;
+	std::chrono::duration<double, std::milli> startupMs = std::chrono::high_resolution_clock::now() - startupTime;
+
+	if (!firstFrameReported) {
+		std::cout << "First frame " << startupMs.count() << " ms after startup, " << houseScene->getPendingShaderCount()
+			<< " shader variants still building" << (ShaderVariants::isParallel() ? " in parallel" : "") << std::endl;
+		firstFrameReported = true;
+	}
+
+	if (!programsReported && houseScene->getPendingShaderCount() == 0) {
+		ProgramBinaryCache::printStats();
+		std::cout << "All shader programs ready " << startupMs.count() << " ms after startup" << std::endl;
+		programsReported = true;
+	}
+
+	// Every pass goes to the CSV each frame, the console only gets an update once a second
+	static float printTimer = 0.0f;
+	printTimer += timeDelta;
+
+	if (printTimer >= 1.0f) {
+		if (gpuProfiler && appSettings.profile) {
+			gpuProfiler->printLatestResults();
+
+			std::cout << "Drew " << houseScene->getDrawnCount() << " objects, frustum culled " << houseScene->getCulledCount()
+				<< ", occluded " << houseScene->getOccludedCount() << std::endl;
+		}
+
+		if (resolutionController)
+			std::cout << "Dynamic resolution scale " << resolutionController->getScale() << std::endl;
+
+		if (adaptiveSupersampler)
+			std::cout << "Adaptive SSAA refined " << adaptiveSupersampler->getRefinedPercent() << "% of pixels" << std::endl;
+
+		printTimer = 0.0f;
+	}
+}
+
+// Renders a fixed number of frames without a window and writes the frames and timings to disk
+int runHeadless(const AppSettings &settings) {
+	HeadlessContext context;
+	if (!context.create())
+		return -1;
+
+	setupRenderSettings();
+	createScenes();
+
+	// Saved frames should be the same every run, not depend on how quickly the variants were built
+	houseScene->finishShaders();
+
+	FrameCapture capture(screenWidth, screenHeight);
+	if (!capture.isOkay())
+		return -1;
+
+	if (!FrameCapture::createDirectory(settings.outputDir))
+		return -1;
+
+	std::ofstream timings(settings.outputDir + "/timings.csv");
+	timings << "frame,render_ms,capture_ms,refined_percent,drawn,culled,occluded" << std::endl;
+
+	// Step the animation by a fixed amount so runs are repeatable
+	const float frameDelta = 1.0f / 60.0f;
+
+	// A benchmark run keeps going until enough frames have been recorded
+	int frame = 0;
+	for (; frameStats ? !frameStats->isFinished() : frame < settings.headlessFrames; frame++) {
+		auto renderStart = std::chrono::high_resolution_clock::now();
+
+		renderFrame(capture.getFramebuffer(), screenWidth, screenHeight, frameDelta);
+
+		// Wait for the GPU so the timing covers the whole frame and not just the command submission
+		glFinish();
+		auto renderEnd = std::chrono::high_resolution_clock::now();
+
+		if (settings.saveFrames) {
+			char fileName[32];
+			snprintf(fileName, sizeof(fileName), "/frame_%05d.ppm", frame);
+			capture.saveFrame(settings.outputDir + fileName);
+		}
+		auto captureEnd = std::chrono::high_resolution_clock::now();
+
+		double renderMs = std::chrono::duration<double, std::milli>(renderEnd - renderStart).count();
+		double captureMs = std::chrono::duration<double, std::milli>(captureEnd - renderEnd).count();
+		timings << frame << "," << renderMs << "," << captureMs << ",";
+
+		// Only adaptive supersampling refines some of the pixels, the column is left empty otherwise
+		if (adaptiveSupersampler)
+			timings << adaptiveSupersampler->getRefinedPercent();
+		timings << "," << houseScene->getDrawnCount() << "," << houseScene->getCulledCount() << "," << houseScene->getOccludedCount() << std::endl;
+
+		if (frameStats)
+			frameStats->addFrame((float)(renderMs / 1000.0));
+	}
+
+	if (frameStats)
+		finishBenchmark();
+
+	std::cout << "Rendered " << frame << " frames to " << settings.outputDir << std::endl;
+	return 0;
+}
+
+// Times the SSAA resolve filters offscreen, nothing else is rendered
+int runResolveBench(const AppSettings &settings) {
+	HeadlessContext context;
+	if (!context.create())
+		return -1;
+
+	return runResolveBenchmark(settings.resolveBenchCSV) ? 0 : -1;
+}
+
+// Times the house scene with more and more lights offscreen at the window's size
+int runLightBench(const AppSettings &settings) {
+	HeadlessContext context;
+	if (!context.create())
+		return -1;
+
+	return runLightBenchmark(screenWidth, screenHeight, settings) ? 0 : -1;
+}
+
+// Compares the post-process AA modes with a supersampled reference offscreen at the window's size
+int runAAQualityBench() {
+	HeadlessContext context;
+	if (!context.create())
+		return -1;
+
+	return runAAQualityBenchmark(screenWidth, screenHeight) ? 0 : -1;
+}
+
+// Writes the benchmark results once the requested number of frames has been recorded
+void finishBenchmark() {
+	frameStats->printSummary(appSettings.benchLabel);
+
+	if (!appSettings.benchCSV.empty())
+		frameStats->writeCSV(appSettings.benchCSV);
+	if (!appSettings.benchJSON.empty())
+		frameStats->writeJSON(appSettings.benchJSON, appSettings.benchLabel);
 }
 
 
@@ -203,32 +657,87 @@ void processInput(GLFWwindow *window)
 		if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
 			ecam->processKeyboard(RIGHT, timer.getDeltaTimeSeconds());
 	}
-	//if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) {
-	//	samples = 1;
-	//	setupHouseScene();
-	//}
-	//if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) {
-	//	samples = 2;
-	//	setupHouseScene();
-	//}
-	//if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) {
-	//	samples = 4;
-	//	setupHouseScene();
-	//}
-	//if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS) {
-	//	samples = 8;
-	//	setupHouseScene();
-	//}
-	//if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS) {
-	//	samples = 16;
-	//	setupHouseScene();
-	//}
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
 	if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
 		showHouseQuad = !showHouseQuad;
+
+	// Only react to the initial press so holding a key doesn't reallocate every frame
+	if (action != GLFW_PRESS || !houseScene)
+		return;
+
+	static const int sampleKeys[][2] = {
+		{ GLFW_KEY_1, 1 },
+		{ GLFW_KEY_2, 2 },
+		{ GLFW_KEY_3, 4 },
+		{ GLFW_KEY_4, 8 },
+		{ GLFW_KEY_5, 16 },
+	};
+
+	for (int i = 0; i < 5; i++) {
+		if (key == sampleKeys[i][0]) {
+			samples = sampleKeys[i][1];
+			setupHouseScene();
+		}
+	}
+
+	if (key == GLFW_KEY_M) {
+		antialiasingType = (AATYPE)((antialiasingType + 1) % AATYPE_COUNT);
+		setupHouseScene();
+	}
+
+	if (key == GLFW_KEY_B) {
+		msaaResolveMode = msaaResolveMode == MSAA_RESOLVE_BLIT ? MSAA_RESOLVE_SHADER : MSAA_RESOLVE_BLIT;
+		setupHouseScene();
+	}
+
+	if (key == GLFW_KEY_V) {
+		sampleShading = !sampleShading;
+		setupHouseScene();
+	}
+
+	if (key == GLFW_KEY_J) {
+		jitterPattern = (SamplePattern)((jitterPattern + 1) % 3);
+		setupHouseScene();
+	}
+
+	if (key == GLFW_KEY_F) {
+		resolveFilter = (ResolveFilter)((resolveFilter + 1) % RESOLVE_FILTER_COUNT);
+		setupHouseScene();
+	}
+
+	if (key == GLFW_KEY_R) {
+		dynamicResTargetMs = dynamicResTargetMs > 0.0f ? 0.0f : DEFAULT_DYNAMIC_RES_TARGET_MS;
+		setupHouseScene();
+	}
+
+	if (key == GLFW_KEY_O) {
+		houseScene->setOcclusionCulling(!houseScene->getOcclusionCulling());
+		std::cout << "Occlusion culling " << (houseScene->getOcclusionCulling() ? "on" : "off") << std::endl;
+	}
+
+	if (key == GLFW_KEY_C) {
+		houseScene->setSoftwareOcclusion(!houseScene->getSoftwareOcclusion());
+		std::cout << "Software occlusion culling " << (houseScene->getSoftwareOcclusion() ? "on" : "off") << std::endl;
+	}
+
+	if (key == GLFW_KEY_G) {
+		shadingPath = shadingPath == SHADING_FORWARD ? SHADING_DEFERRED : SHADING_FORWARD;
+		houseScene->setShadingPath(shadingPath);
+		std::cout << "Shading " << shadingPathName(shadingPath) << (shadingPath == SHADING_DEFERRED && !houseScene->isDeferred() ? " (forward while MSAA is on)" : "") << std::endl;
+	}
+
+	if (key == GLFW_KEY_L) {
+		houseScene->setLightClustering(!houseScene->getLightClustering());
+		std::cout << "Light clustering " << (houseScene->getLightClustering() ? "on" : "off") << " (" << houseScene->getPointLightCount() << " lights)" << std::endl;
+	}
+
+	if (key == GLFW_KEY_T) {
+		ssaaTileSize = ssaaTileSize > 0 ? 0 : DEFAULT_SSAA_TILE_SIZE;
+		setupHouseScene();
+	}
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -237,6 +746,13 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 	// make sure the viewport matches the new window dimensions; note that width and 
 	glViewport(0, 0, width, height);
 	camera.updateScreenSize(width, height);
+
+	// Minimising the window reports a size of 0
+	if (houseScene && width > 0 && height > 0) {
+		screenWidth = width;
+		screenHeight = height;
+		setupHouseScene();
+	}
 }
 
 // glfw: whenever the mouse moves, this callback is called
@@ -0,0 +1,130 @@
+#include "TemporalAA.h"
+#include "ShaderVariants.h"
+#include "SamplePatterns.h"
+#include <iostream>
+
+using namespace std;
+
+TemporalAA::TemporalAA(int newOutputWidth, int newOutputHeight, float newBlendFactor) {
+	outputWidth = newOutputWidth;
+	outputHeight = newOutputHeight;
+	blendFactor = newBlendFactor;
+
+	GLSL_ERROR glsl_err = ShaderVariants::createShaderProgram(
+		string("Resources/Shaders/Resolve_shader.vert"),
+		string("Resources/Shaders/TAA_shader.frag"),
+		&taaShader);
+
+	reprojectionLocation = glGetUniformLocation(taaShader, "reprojection");
+	blendFactorLocation = glGetUniformLocation(taaShader, "blendFactor");
+	historyValidLocation = glGetUniformLocation(taaShader, "historyValid");
+
+	glUseProgram(taaShader);
+	glUniform1i(glGetUniformLocation(taaShader, "currentTexture"), 0);
+	glUniform1i(glGetUniformLocation(taaShader, "depthTexture"), 1);
+	glUniform1i(glGetUniformLocation(taaShader, "historyTexture"), 2);
+	glUseProgram(0);
+
+	glGenVertexArrays(1, &emptyVAO);
+
+	// History is filtered when it's reprojected and is blended a little at a time, so keep it in
+	// half float to stop the small contributions being rounded away
+	createTexture(&outputTexture, GL_RGBA8, GL_NEAREST);
+	createTexture(&historyTextures[0], GL_RGBA16F, GL_LINEAR);
+	createTexture(&historyTextures[1], GL_RGBA16F, GL_LINEAR);
+
+	fboOkay = true;
+	glGenFramebuffers(2, fbos);
+
+	for (int i = 0; i < 2; i++) {
+		glBindFramebuffer(GL_FRAMEBUFFER, fbos[i]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outputTexture, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, historyTextures[i], 0);
+
+		GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, drawBuffers);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			fboOkay = false;
+			cout << "Could not successfully create framebuffer object for TAA!" << endl;
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+TemporalAA::~TemporalAA() {
+	glDeleteFramebuffers(2, fbos);
+	glDeleteTextures(1, &outputTexture);
+	glDeleteTextures(2, historyTextures);
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(taaShader);
+}
+
+void TemporalAA::createTexture(GLuint *texture, GLint internalFormat, GLint filter) {
+	glGenTextures(1, texture);
+	glBindTexture(GL_TEXTURE_2D, *texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, outputWidth, outputHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+glm::mat4 TemporalAA::getJitter() {
+	// Halton index 0 is (0, 0), start from 1 so every phase is a real offset
+	int phase = frame % JITTER_PHASES + 1;
+	glm::vec2 offset(halton(phase, 2) - 0.5f, halton(phase, 3) - 0.5f);
+
+	// A pixel is 2 / size wide in NDC
+	return glm::translate(glm::mat4(1.0), glm::vec3(2.0f * offset.x / outputWidth, 2.0f * offset.y / outputHeight, 0.0f));
+}
+
+void TemporalAA::resolve(GLuint colourTexture, GLuint depthTexture, const glm::mat4 &viewProjection) {
+	if (!fboOkay)
+		return;
+
+	glm::mat4 reprojection = previousViewProjection * glm::inverse(viewProjection);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbos[current]);
+	glViewport(0, 0, outputWidth, outputHeight);
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glUseProgram(taaShader);
+	glUniformMatrix4fv(reprojectionLocation, 1, GL_FALSE, glm::value_ptr(reprojection));
+	glUniform1f(blendFactorLocation, blendFactor);
+	glUniform1i(historyValidLocation, historyValid);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, colourTexture);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, historyTextures[1 - current]);
+
+	glBindVertexArray(emptyVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	glActiveTexture(GL_TEXTURE0);
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	previousViewProjection = viewProjection;
+	historyValid = true;
+	current = 1 - current;
+	frame++;
+}
+
+void TemporalAA::reset() {
+	historyValid = false;
+}
+
+GLuint TemporalAA::getOutputTexture() {
+	return outputTexture;
+}
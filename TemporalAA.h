@@ -0,0 +1,57 @@
+#ifndef TEMPORALAA_H
+#define TEMPORALAA_H
+
+#include "Includes.h"
+
+// Temporal anti-aliasing. The scene is rendered at the output resolution with the projection
+// jittered by a different sub-pixel offset each frame (getJitter), then resolve() blends it into
+// a history buffer that is reprojected with depth and the previous view-projection and clamped
+// to the current neighbourhood. Edges converge towards supersampled quality over a few frames.
+class TemporalAA {
+	private:
+		// Length of the Halton (2, 3) jitter sequence before it repeats
+		static const int				JITTER_PHASES = 8;
+
+		int								outputWidth;
+		int								outputHeight;
+
+		int								frame = 0;
+		bool							historyValid = false;
+		float							blendFactor;
+
+		// Unjittered view-projection of the last resolved frame
+		glm::mat4						previousViewProjection;
+
+		// The resolve writes the displayed image and the new history together (two colour attachments).
+		// History textures ping-pong, fbos[i] writes historyTextures[i] and reads the other one.
+		GLuint							outputTexture;
+		GLuint							historyTextures[2];
+		GLuint							fbos[2];
+		int								current = 0;
+		bool							fboOkay;
+
+		GLuint							emptyVAO;
+
+		GLuint							taaShader;
+		GLint							reprojectionLocation;
+		GLint							blendFactorLocation;
+		GLint							historyValidLocation;
+
+		void							createTexture(GLuint *texture, GLint internalFormat, GLint filter);
+
+	public:
+		TemporalAA(int newOutputWidth, int newOutputHeight, float newBlendFactor = 0.1f);
+		~TemporalAA();
+
+		// Projection offset to render this frame's scene with, apply after the camera's projection
+		glm::mat4 getJitter();
+
+		// Blends the jittered scene into the history, viewProjection is this frame's unjittered matrix
+		void resolve(GLuint colourTexture, GLuint depthTexture, const glm::mat4 &viewProjection);
+
+		// Throw the history away, e.g. after a camera cut
+		void reset();
+
+		GLuint getOutputTexture();
+};
+#endif
@@ -0,0 +1,137 @@
+// Checks OcclusionRasterizer on known triangles with every SIMD path this CPU can run. Only needs GLM,
+// no GL context. With an identity view-projection the occluders are given straight in NDC, so the
+// depth buffer's values are the triangles' own z.
+#include "OcclusionRasterizer.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+static const int BUFFER_WIDTH = 64;
+static const int BUFFER_HEIGHT = 64;
+
+static int failures = 0;
+
+static void check(bool passed, const char *kernelsName, const char *what) {
+	if (!passed) {
+		printf("FAILED (%s): %s\n", kernelsName, what);
+		failures++;
+	}
+}
+
+static float depthAt(OcclusionRasterizer &rasterizer, int x, int y) {
+
+	return rasterizer.getDepthBuffer()[y * rasterizer.getWidth() + x];
+}
+
+// A square from -0.5 to 0.5 on x and y at depth z, as two triangles
+static void addSquare(OcclusionRasterizer *rasterizer, float z) {
+	vector<glm::vec3> positions = {
+		glm::vec3(-0.5f, -0.5f, z), glm::vec3(0.5f, -0.5f, z), glm::vec3(0.5f, 0.5f, z), glm::vec3(-0.5f, 0.5f, z)
+	};
+	vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3 };
+
+	rasterizer->addOccluder(positions, indices, glm::mat4(1.0f));
+}
+
+static void testSquare(const OcclusionKernels *kernels) {
+	OcclusionRasterizer rasterizer(BUFFER_WIDTH, BUFFER_HEIGHT, 2);
+	rasterizer.setKernels(kernels);
+	addSquare(&rasterizer, 0.0f);
+	rasterizer.render(glm::mat4(1.0f));
+
+	check(rasterizer.getRasterizedTriangleCount() == 2, kernels->name, "both triangles of the square are rasterized");
+
+	// The square covers pixels 16 to 47 on both axes
+	check(depthAt(rasterizer, 32, 32) == 0.0f, kernels->name, "centre pixel has the square's depth");
+	check(depthAt(rasterizer, 16, 16) == 0.0f && depthAt(rasterizer, 47, 47) == 0.0f, kernels->name, "corner pixels inside the square are drawn");
+	check(depthAt(rasterizer, 15, 32) == 1.0f && depthAt(rasterizer, 48, 32) == 1.0f, kernels->name, "pixels left and right of the square are clear");
+	check(depthAt(rasterizer, 32, 15) == 1.0f && depthAt(rasterizer, 32, 48) == 1.0f, kernels->name, "pixels below and above the square are clear");
+
+	check(!rasterizer.isVisible(glm::vec3(-0.3f, -0.3f, 0.2f), glm::vec3(0.3f, 0.3f, 0.5f)), kernels->name, "box behind the square is occluded");
+	check(rasterizer.isVisible(glm::vec3(-0.3f, -0.3f, -0.5f), glm::vec3(0.3f, 0.3f, -0.2f)), kernels->name, "box in front of the square is visible");
+	check(rasterizer.isVisible(glm::vec3(-0.3f, -0.3f, -0.1f), glm::vec3(0.3f, 0.3f, 0.3f)), kernels->name, "box through the square is visible");
+	check(rasterizer.isVisible(glm::vec3(0.3f, -0.3f, 0.2f), glm::vec3(0.8f, 0.3f, 0.5f)), kernels->name, "box behind the square's edge and sticking out is visible");
+	check(rasterizer.isVisible(glm::vec3(0.6f, 0.6f, 0.2f), glm::vec3(0.9f, 0.9f, 0.5f)), kernels->name, "box where nothing was drawn is visible");
+	check(!rasterizer.isVisible(glm::vec3(-0.49f, -0.49f, 0.2f), glm::vec3(0.49f, 0.49f, 0.5f)), kernels->name, "box just inside the square's outline is occluded");
+	check(rasterizer.isVisible(glm::vec3(-0.3f, -0.3f, -1.5f), glm::vec3(0.3f, 0.3f, 0.5f)), kernels->name, "box crossing the near plane is visible");
+
+	// Drawn again from a different view, nothing of the last one should be left
+	rasterizer.render(glm::translate(glm::mat4(1.0f), glm::vec3(2.0f, 0.0f, 0.0f)));
+	check(depthAt(rasterizer, 32, 32) == 1.0f, kernels->name, "render() clears the previous frame");
+	check(rasterizer.isVisible(glm::vec3(-2.3f, -0.3f, 0.2f), glm::vec3(-1.7f, 0.3f, 0.5f)), kernels->name, "box where the square was is visible once it moved away");
+}
+
+// A triangle leaning away from the camera, its depth changes across x
+static void testSlope(const OcclusionKernels *kernels) {
+	OcclusionRasterizer rasterizer(BUFFER_WIDTH, BUFFER_HEIGHT, 1);
+	rasterizer.setKernels(kernels);
+
+	vector<glm::vec3> positions = { glm::vec3(-1.0f, -1.0f, -0.5f), glm::vec3(1.0f, -1.0f, 0.5f), glm::vec3(1.0f, 1.0f, 0.5f), glm::vec3(-1.0f, 1.0f, -0.5f) };
+	vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3 };
+	rasterizer.addOccluder(positions, indices, glm::mat4(1.0f));
+	rasterizer.render(glm::mat4(1.0f));
+
+	// Pixel x's centre is at NDC (x + 0.5) / 32 - 1, and depth is half of that
+	bool interpolated = true;
+	for (int x = 0; x < BUFFER_WIDTH; x++) {
+		float expected = 0.5f * ((x + 0.5f) / 32.0f - 1.0f);
+		interpolated = interpolated && fabs(depthAt(rasterizer, x, 10) - expected) < 1e-5f;
+	}
+	check(interpolated, kernels->name, "depth is interpolated across a sloped quad");
+
+	// Near the left edge the quad is at about -0.5, near the right at about 0.5
+	check(!rasterizer.isVisible(glm::vec3(-0.9f, -0.2f, -0.3f), glm::vec3(-0.7f, 0.2f, -0.2f)), kernels->name, "box behind the near side of the slope is occluded");
+	check(rasterizer.isVisible(glm::vec3(0.7f, -0.2f, -0.3f), glm::vec3(0.9f, 0.2f, -0.2f)), kernels->name, "box in front of the far side of the slope is visible");
+}
+
+// Every path has to give exactly the same buffer, otherwise the same scene would cull differently
+static void testPathsMatch(const OcclusionKernels *kernels) {
+	const OcclusionKernels *baseline = getBaselineOcclusionKernels();
+	if (kernels == baseline)
+		return;
+
+	vector<glm::vec3> positions;
+	vector<unsigned int> indices;
+	for (int i = 0; i < 64; i++) {
+		float angle = i * 0.7f;
+		positions.push_back(glm::vec3(cos(angle) * 0.9f, sin(angle * 1.3f) * 0.9f, sin(angle * 0.4f) * 0.8f));
+		if (i >= 2)
+			indices.insert(indices.end(), { (unsigned int)i - 2, (unsigned int)i - 1, (unsigned int)i });
+	}
+
+	glm::mat4 viewProjection = glm::perspective(1.0f, 1.0f, 0.1f, 10.0f) * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.0f));
+
+	OcclusionRasterizer first(BUFFER_WIDTH, BUFFER_HEIGHT, 1), second(BUFFER_WIDTH, BUFFER_HEIGHT, 1);
+	first.setKernels(baseline);
+	second.setKernels(kernels);
+	first.addOccluder(positions, indices, glm::mat4(1.0f));
+	second.addOccluder(positions, indices, glm::mat4(1.0f));
+	first.render(viewProjection);
+	second.render(viewProjection);
+
+	check(first.getDepthBuffer() == second.getDepthBuffer(), kernels->name, "depth buffer matches the baseline path");
+}
+
+int main() {
+	vector<const OcclusionKernels*> kernelSets = { getBaselineOcclusionKernels() };
+	if (getAVX2OcclusionKernels())
+		kernelSets.push_back(getAVX2OcclusionKernels());
+
+	for (const OcclusionKernels *kernels : kernelSets) {
+		printf("Testing the %s path\n", kernels->name);
+		testSquare(kernels);
+		testSlope(kernels);
+		testPathsMatch(kernels);
+	}
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+
+	printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,50 @@
+#include "TiledRenderer.h"
+#include <algorithm>
+
+using namespace std;
+
+TiledRenderer::TiledRenderer(HouseScene *newScene, SSAAResolver *newResolver, int newOutputWidth, int newOutputHeight, int sampleSize, int tileSize) {
+	scene = newScene;
+	resolver = newResolver;
+	outputWidth = newOutputWidth;
+	outputHeight = newOutputHeight;
+	samples = sampleSize;
+
+	// Tiles are cut on output pixel boundaries so every resolve box lies inside one tile
+	tileOutputSize = max(1, tileSize / samples);
+}
+
+// Maps the NDC rectangle covered by the output pixels [x, x + width) x [y, y + height) onto
+// the whole of clip space. It's applied after the projection so it works in clip coordinates,
+// glm::translate puts the offset in the w column so it's scaled by w like the rest of the point.
+glm::mat4 TiledRenderer::tileProjection(int x, int y, int width, int height) {
+	float x0 = -1.0f + 2.0f * x / outputWidth;
+	float x1 = -1.0f + 2.0f * (x + width) / outputWidth;
+	float y0 = -1.0f + 2.0f * y / outputHeight;
+	float y1 = -1.0f + 2.0f * (y + height) / outputHeight;
+
+	glm::vec3 scale(2.0f / (x1 - x0), 2.0f / (y1 - y0), 1.0f);
+	glm::vec3 offset(-(x0 + x1) / (x1 - x0), -(y0 + y1) / (y1 - y0), 0.0f);
+
+	return glm::scale(glm::translate(glm::mat4(1.0), offset), scale);
+}
+
+int TiledRenderer::getTileCount() {
+	int across = (outputWidth + tileOutputSize - 1) / tileOutputSize;
+	int down = (outputHeight + tileOutputSize - 1) / tileOutputSize;
+
+	return across * down;
+}
+
+void TiledRenderer::render() {
+	for (int y = 0; y < outputHeight; y += tileOutputSize) {
+		for (int x = 0; x < outputWidth; x += tileOutputSize) {
+			// Tiles on the right and top edges may be smaller
+			int width = min(tileOutputSize, outputWidth - x);
+			int height = min(tileOutputSize, outputHeight - y);
+
+			scene->render(tileProjection(x, y, width, height), width * samples, height * samples);
+			resolver->resolveRegion(scene->getHouseSceneTexture(), x, y, width, height);
+		}
+	}
+}
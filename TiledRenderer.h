@@ -0,0 +1,34 @@
+#ifndef TILEDRENDERER_H
+#define TILEDRENDERER_H
+
+#include "Includes.h"
+#include "HouseScene.h"
+#include "SSAAResolver.h"
+
+// Renders a supersampled image one screen tile at a time so the scene only ever needs a
+// tileSize x tileSize target, whatever the SSAA factor. Each tile is drawn with a projection
+// offset that stretches its part of the image over the tile FBO and is then resolved straight
+// into its rectangle of the resolver's output texture.
+class TiledRenderer {
+	private:
+		HouseScene						*scene;
+		SSAAResolver					*resolver;
+
+		int								outputWidth;
+		int								outputHeight;
+		int								samples;
+
+		// Size of a tile in output pixels, the scene renders it at (tileOutputSize * samples)^2
+		int								tileOutputSize;
+
+		glm::mat4						tileProjection(int x, int y, int width, int height);
+
+	public:
+		TiledRenderer(HouseScene *newScene, SSAAResolver *newResolver, int newOutputWidth, int newOutputHeight, int sampleSize, int tileSize);
+
+		int getTileCount();
+
+		// Renders and resolves every tile, the finished image is in the resolver's output texture
+		void render();
+};
+#endif
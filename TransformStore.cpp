@@ -0,0 +1,51 @@
+#include "TransformStore.h"
+
+using namespace std;
+
+int TransformStore::add(const glm::mat4 &modelMatrix, const BoundingBox &localBounds) {
+	Transform transform;
+	transform.modelMatrix = modelMatrix;
+	transform.localBounds = localBounds;
+	transform.dirty = true;
+
+	transforms.push_back(transform);
+	anyDirty = true;
+
+	return (int)transforms.size() - 1;
+}
+
+void TransformStore::set(int id, const glm::mat4 &modelMatrix) {
+	transforms[id].modelMatrix = modelMatrix;
+	transforms[id].dirty = true;
+	anyDirty = true;
+}
+
+void TransformStore::update() {
+	if (!anyDirty)
+		return;
+
+	for (Transform &transform : transforms) {
+		if (transform.dirty) {
+			transform.invTransposeMatrix = glm::transpose(glm::inverse(transform.modelMatrix));
+			transform.worldBounds = transform.localBounds.transformed(transform.modelMatrix);
+			transform.dirty = false;
+		}
+	}
+
+	anyDirty = false;
+}
+
+const glm::mat4& TransformStore::getModelMatrix(int id) {
+
+	return transforms[id].modelMatrix;
+}
+
+const glm::mat4& TransformStore::getInvTransposeMatrix(int id) {
+
+	return transforms[id].invTransposeMatrix;
+}
+
+const BoundingBox& TransformStore::getWorldBounds(int id) {
+
+	return transforms[id].worldBounds;
+}
@@ -0,0 +1,41 @@
+#ifndef TRANSFORMSTORE_H
+#define TRANSFORMSTORE_H
+
+#include "Includes.h"
+#include "Frustum.h"
+#include <vector>
+
+// Model matrices of the scene's objects along with their inverse transposes (for the normals) and
+// world space bounds. The inverse transpose and bounds are only recomputed by update() for
+// transforms that were changed with set(), so objects that never move cost nothing per frame.
+class TransformStore {
+	private:
+		struct Transform {
+			glm::mat4					modelMatrix;
+			glm::mat4					invTransposeMatrix;
+			BoundingBox					localBounds;
+			BoundingBox					worldBounds;
+			bool						dirty;
+		};
+		std::vector<Transform>			transforms;
+
+		// Set when any transform is dirty so update() can return straight away
+		bool							anyDirty = false;
+
+	public:
+		// Returns the ID used to refer to the transform from now on. localBounds are the model's own
+		// bounds, the default never gets culled.
+		int add(const glm::mat4 &modelMatrix, const BoundingBox &localBounds = BoundingBox::everything());
+
+		void set(int id, const glm::mat4 &modelMatrix);
+
+		// Recomputes the inverse transposes of every transform changed since the last update
+		void update();
+
+		const glm::mat4& getModelMatrix(int id);
+
+		// Only up to date after update()
+		const glm::mat4& getInvTransposeMatrix(int id);
+		const BoundingBox& getWorldBounds(int id);
+};
+#endif
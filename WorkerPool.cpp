@@ -0,0 +1,66 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+using namespace std;
+
+WorkerPool::WorkerPool(int threads, int maxThreads) {
+	threadCount = threads > 0 ? threads : (int)thread::hardware_concurrency();
+	if (maxThreads > 0)
+		threadCount = min(threadCount, maxThreads);
+	threadCount = max(1, threadCount);
+
+	for (int i = 0; i < threadCount - 1; i++)
+		workers.push_back(thread(&WorkerPool::workerLoop, this, i));
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		lock_guard<mutex> lock(workerMutex);
+		stopping = true;
+	}
+	workerWake.notify_all();
+
+	for (thread &worker : workers)
+		worker.join();
+}
+
+void WorkerPool::workerLoop(int threadIndex) {
+	int lastGeneration = 0;
+
+	while (true) {
+		unique_lock<mutex> lock(workerMutex);
+		workerWake.wait(lock, [&] { return stopping || jobGeneration != lastGeneration; });
+
+		if (stopping)
+			return;
+
+		lastGeneration = jobGeneration;
+		lock.unlock();
+
+		workerJob(threadIndex);
+
+		lock.lock();
+		if (--workersBusy == 0)
+			workerDone.notify_one();
+	}
+}
+
+void WorkerPool::run(const function<void(int)> &job) {
+	{
+		lock_guard<mutex> lock(workerMutex);
+		workerJob = job;
+		workersBusy = (int)workers.size();
+		jobGeneration++;
+	}
+	workerWake.notify_all();
+
+	job(threadCount - 1);
+
+	unique_lock<mutex> lock(workerMutex);
+	workerDone.wait(lock, [this] { return workersBusy == 0; });
+}
+
+int WorkerPool::getThreadCount() {
+
+	return threadCount;
+}
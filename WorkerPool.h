@@ -0,0 +1,38 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads that are started once and woken for each job, starting threads every frame costs more
+// than the per-frame jobs they're used for. The calling thread does a share of each job too, so
+// there's one fewer worker than the thread count.
+class WorkerPool {
+	private:
+		int								threadCount;
+
+		std::vector<std::thread>		workers;
+		std::mutex						workerMutex;
+		std::condition_variable			workerWake;
+		std::condition_variable			workerDone;
+		std::function<void(int)>		workerJob;
+		int								jobGeneration = 0;
+		int								workersBusy = 0;
+		bool							stopping = false;
+
+		void							workerLoop(int threadIndex);
+
+	public:
+		// threads = 0 uses one per core, maxThreads caps it when there's only so much to share out
+		WorkerPool(int threads = 0, int maxThreads = 0);
+		~WorkerPool();
+
+		// Calls job(0) ... job(threadCount - 1) on all the threads and waits for them
+		void run(const std::function<void(int)> &job);
+
+		int getThreadCount();
+};
+#endif